@@ -0,0 +1,192 @@
+#include "compiler/patternTree.hpp"
+#include "compiler/resolvedPattern.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Pattern tree microbenchmark
+ *
+ * Builds an effect tree shaped like the prelude plus a wide fan-out of
+ * synthetic effects, then matches a fixed set of lines against it and reports
+ * how many tree nodes are visited per second. A second tree holds one effect
+ * with many optional [word |] groups, to show that inserting it grows the
+ * tree with the number of groups rather than with the 2^groups variants.
+ * A third tree holds effects that start with a $ slot, like user-defined
+ * effects on a subject; the literal pre-filter keeps lines that name none of
+ * their words from trying every split of the line against them.
+ *
+ * Usage: patternTreeBench [repetitions] [optional groups]
+ */
+
+namespace {
+
+std::unique_ptr<tbx::ResolvedPattern> makePattern(const std::string &text,
+                                                  tbx::PatternType type) {
+  auto pattern = std::make_unique<tbx::ResolvedPattern>();
+  pattern->pattern = text;
+  pattern->originalText = text;
+  pattern->type = type;
+  return pattern;
+}
+
+std::vector<std::unique_ptr<tbx::ResolvedPattern>> makePatterns() {
+  std::vector<std::unique_ptr<tbx::ResolvedPattern>> patterns;
+  const char *effects[] = {"return $",        "set $ to $",
+                           "[print|write] $ [|to the console]",
+                           "multiply $ by $", "add $ to $",
+                           "subtract $ from $", "divide $ by $"};
+  for (const char *text : effects) {
+    patterns.push_back(makePattern(text, tbx::PatternType::Effect));
+  }
+  const char *expressions[] = {"$ + $", "$ - $", "$ * $", "$ / $",
+                               "$ [is equal to|=] $", "$ [is less than|<] $"};
+  for (const char *text : expressions) {
+    patterns.push_back(makePattern(text, tbx::PatternType::Expression));
+  }
+  for (int index = 0; index < 200; index++) {
+    patterns.push_back(makePattern("action" + std::to_string(index) +
+                                       " on $ with $",
+                                   tbx::PatternType::Effect));
+  }
+  return patterns;
+}
+
+std::vector<std::string> makeLines() {
+  std::vector<std::string> lines;
+  for (int index = 0; index < 100; index++) {
+    std::string name = "x" + std::to_string(index);
+    lines.push_back("set " + name + " to a + b * c - d");
+    lines.push_back("print " + name);
+    lines.push_back("add 1 to " + name);
+    lines.push_back("action" + std::to_string(index * 2) + " on " + name +
+                    " with 3");
+  }
+  return lines;
+}
+
+std::vector<std::unique_ptr<tbx::ResolvedPattern>> makeSubjectPatterns() {
+  std::vector<std::unique_ptr<tbx::ResolvedPattern>> patterns;
+  for (int index = 0; index < 300; index++) {
+    std::string team = "team" + std::to_string(index);
+    patterns.push_back(
+        makePattern("$ joins " + team, tbx::PatternType::Effect));
+    patterns.push_back(
+        makePattern("$ leaves " + team + " after $ days",
+                    tbx::PatternType::Effect));
+  }
+  patterns.push_back(makePattern("set $ to $", tbx::PatternType::Effect));
+  return patterns;
+}
+
+std::string makeOptionalGroupsPattern(int groups) {
+  std::string text;
+  for (int group = 0; group < groups; group++) {
+    text += "[word" + std::to_string(group) + " |]";
+  }
+  return text + "shout $";
+}
+
+std::vector<std::string> makeOptionalGroupsLines(int groups) {
+  std::vector<std::string> lines = {"shout x"};
+  std::string every;
+  std::string even;
+  for (int group = 0; group < groups; group++) {
+    std::string word = "word" + std::to_string(group) + " ";
+    every += word;
+    if (group % 2 == 0) {
+      even += word;
+    }
+    lines.push_back(word + "shout x");
+  }
+  lines.push_back(every + "shout x");
+  lines.push_back(even + "shout x");
+  return lines;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  int repetitions = argc > 1 ? std::atoi(argv[1]) : 20;
+  int optionalGroups = argc > 2 ? std::atoi(argv[2]) : 24;
+
+  auto patterns = makePatterns();
+  std::vector<std::string> lines = makeLines();
+
+  tbx::PatternTree tree;
+  for (auto &pattern : patterns) {
+    tree.addPattern(pattern.get());
+  }
+
+  size_t matched = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int repetition = 0; repetition < repetitions; repetition++) {
+    for (const std::string &line : lines) {
+      if (tree.match(line)) {
+        matched++;
+      }
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  double seconds = std::chrono::duration<double>(end - start).count();
+  size_t lineCount = lines.size() * static_cast<size_t>(repetitions);
+  std::cout << "lines matched:     " << matched << " / " << lineCount << "\n";
+  std::cout << "time:              " << seconds << " s\n";
+  std::cout << "nodes visited:     " << tree.nodesVisited() << "\n";
+  std::cout << "nodes per second:  " << tree.nodesVisited() / seconds << "\n";
+  std::cout << "lines per second:  " << lineCount / seconds << "\n";
+
+  // Most lines name no subject effect, so they only reach "set $ to $"
+  auto subjectPatterns = makeSubjectPatterns();
+  tbx::PatternTree subjectTree;
+  for (auto &pattern : subjectPatterns) {
+    subjectTree.addPattern(pattern.get());
+  }
+  size_t subjectMatched = 0;
+  auto subjectStart = std::chrono::steady_clock::now();
+  for (int repetition = 0; repetition < repetitions; repetition++) {
+    for (const std::string &line : lines) {
+      if (subjectTree.match(line)) {
+        subjectMatched++;
+      }
+    }
+  }
+  auto subjectEnd = std::chrono::steady_clock::now();
+  double subjectSeconds =
+      std::chrono::duration<double>(subjectEnd - subjectStart).count();
+  std::cout << "subject matched:   " << subjectMatched << " / " << lineCount
+            << "\n";
+  std::cout << "subject time:      " << subjectSeconds << " s\n";
+  std::cout << "subject nodes:     " << subjectTree.nodesVisited() << "\n";
+
+  // Every line uses the groups in order, so all of them must match
+  auto groupsPattern = makePattern(makeOptionalGroupsPattern(optionalGroups),
+                                   tbx::PatternType::Effect);
+  std::vector<std::string> groupsLines =
+      makeOptionalGroupsLines(optionalGroups);
+  tbx::PatternTree groupsTree;
+  auto insertStart = std::chrono::steady_clock::now();
+  groupsTree.addPattern(groupsPattern.get());
+  auto insertEnd = std::chrono::steady_clock::now();
+
+  size_t groupsMatched = 0;
+  for (const std::string &line : groupsLines) {
+    auto match = groupsTree.match(line);
+    if (match && match->consumedLength == line.size()) {
+      groupsMatched++;
+    }
+  }
+  double insertSeconds =
+      std::chrono::duration<double>(insertEnd - insertStart).count();
+  std::cout << "optional groups:   " << optionalGroups << "\n";
+  std::cout << "insert time:       " << insertSeconds << " s\n";
+  std::cout << "tree nodes:        " << groupsTree.nodeCount() << "\n";
+  std::cout << "group lines:       " << groupsMatched << " / "
+            << groupsLines.size() << "\n";
+  return groupsMatched == groupsLines.size() ? 0 : 1;
+}
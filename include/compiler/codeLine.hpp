@@ -1,9 +1,14 @@
 #pragma once
 
+#include "compiler/lineLiteral.hpp"
+#include "compiler/lineWord.hpp"
 #include "compiler/patternType.hpp"
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace tbx {
 
@@ -27,18 +32,21 @@ struct CodeLine {
   PatternType type =
       PatternType::Effect; // The type of pattern (if isPatternDefinition)
   bool isResolved = false; // Has this line been resolved?
-  std::unique_ptr<Section> childSection; // If line ends with ":"
+  Section *childSection = nullptr;       // If line ends with ":"
+  Section *parentSection = nullptr;      // Section this line belongs to
   int lineNumber = 0;                    // Original line number in source
-  std::string filePath;                  // Original source file path
+  uint32_t fileSymbol = 0;               // Interned original source path
   int startColumn = 0;                   // 0-based start column of actual code
   int endColumn = 0;                     // 0-based end column of actual code
+  std::vector<LineWord> words;           // Words of text, split once
+  std::vector<LineLiteral> literals;     // Literal spans of text, found once
 
   // Default constructor
   CodeLine() = default;
 
   // Constructor with text
-  explicit CodeLine(const std::string &lineText, int lineNum = 0,
-                    std::string file = "", int startCol = 0, int endCol = 0);
+  explicit CodeLine(std::string_view lineText, int lineNum = 0,
+                    uint32_t file = 0, int startCol = 0, int endCol = 0);
 
   // Move constructor and assignment
   CodeLine(CodeLine &&other) noexcept = default;
@@ -47,7 +55,7 @@ struct CodeLine {
   // Clone for patterns: extraction
   std::unique_ptr<CodeLine> clone() const;
 
-  // No copy (due to unique_ptr)
+  // No copy (a copy would share the child section)
   CodeLine(const CodeLine &) = delete;
   CodeLine &operator=(const CodeLine &) = delete;
 
@@ -56,6 +64,11 @@ struct CodeLine {
    */
   bool hasChildSection() const { return childSection != nullptr; }
 
+  /**
+   * Get the original source file path
+   */
+  const std::string &filePath() const;
+
   /**
    * Get the pattern text (without the trailing ":" if present)
    */
@@ -4,6 +4,7 @@
 
 #include <llvm/IR/Function.h>
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -18,6 +19,7 @@ struct CodegenPattern {
   std::string functionName;                // Generated LLVM function name
   llvm::Function *llvmFunction = nullptr;  // The generated LLVM function
   std::vector<std::string> parameterNames; // Ordered parameter names
+  std::vector<uint32_t> patternWords;      // Interned words of the pattern
 };
 
 } // namespace tbx
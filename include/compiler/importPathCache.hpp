@@ -0,0 +1,56 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace tbx {
+
+/**
+ * ImportPathCache - Remembered import path resolutions
+ *
+ * Maps an import path and the directory of the importing file to the file it
+ * resolved to, or to an empty string when no file was found, so the search up
+ * the directory tree runs once per pair and process. Entries only go stale
+ * when files are created or deleted; invalidate() drops every entry a changed
+ * file could affect. Access is thread-safe.
+ */
+class ImportPathCache {
+public:
+  /**
+   * The cache shared by the compiler and the language server
+   */
+  static ImportPathCache &global();
+
+  /**
+   * Look up a resolution
+   * @param resolvedPath Set to the cached path, empty for a cached miss
+   * @return false if the pair has not been resolved yet
+   */
+  bool find(const std::string &importPath, const std::string &sourceDir,
+            std::string &resolvedPath) const;
+
+  /**
+   * Remember a resolution; an empty resolvedPath records a miss
+   */
+  void store(const std::string &importPath, const std::string &sourceDir,
+             const std::string &resolvedPath);
+
+  /**
+   * Forget the entries that a file created, changed or deleted at path could
+   * change: those that resolved to it and those looking for its file name
+   */
+  void invalidate(const std::string &path);
+
+  /**
+   * Forget every entry
+   */
+  void clear();
+
+private:
+  std::map<std::pair<std::string, std::string>, std::string> entries;
+  mutable std::mutex mutex;
+};
+
+} // namespace tbx
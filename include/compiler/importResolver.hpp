@@ -1,10 +1,15 @@
 #pragma once
 
 #include "compiler/diagnostic.hpp"
+#include "compiler/mappedFile.hpp"
+#include "compiler/sourceMapEntry.hpp"
+#include <deque>
 #include <filesystem>
 #include <map>
 #include <set>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace tbx {
@@ -15,6 +20,10 @@ namespace tbx {
  * Reads source files and merges them by resolving imports.
  * Import lines are replaced with the contents of the imported files.
  *
+ * Files are memory-mapped and the merged program is a list of line views into
+ * them, so nothing is concatenated. The views stay valid until the resolver
+ * is destroyed or resolves again.
+ *
  * Key principle: NO hardcoded keywords. The word "import" is detected
  * by simple text matching at the start of a line, not as a reserved keyword.
  */
@@ -29,28 +38,44 @@ public:
   /**
    * Resolve all imports in a source file and return merged source
    * @param filePath Path to the source file
-   * @return Merged source code with all imports inlined
+   * @return Lines of the merged source with all imports inlined
    */
-  std::string resolve(const std::string &filePath);
+  const std::vector<std::string_view> &resolve(const std::string &filePath);
 
   /**
    * Resolve all imports in a source file, auto-loading prelude if not imported
    * @param filePath Path to the source file
    * @param overrideContent Optional content to use instead of reading from
    * filePath
-   * @return Merged source code with all imports inlined (including prelude)
+   * @return Lines of the merged source with all imports inlined (including
+   * prelude)
    */
-  std::string resolveWithPrelude(const std::string &filePath,
-                                 const std::string &overrideContent = "");
+  const std::vector<std::string_view> &
+  resolveWithPrelude(const std::string &filePath,
+                     const std::string &overrideContent = "");
 
   /**
    * Resolve imports from source code string
    * @param source The source code string
    * @param sourcePath Path of the source file (for relative imports)
-   * @return Merged source code with all imports inlined
+   * @return Lines of the merged source with all imports inlined
+   */
+  const std::vector<std::string_view> &
+  resolveSource(const std::string &source, const std::string &sourcePath);
+
+  /**
+   * Resolve and read imports on up to jobs threads before merging
+   * The merged output and source map do not depend on the job count.
+   */
+  void setJobCount(int jobs) { jobCount = jobs < 1 ? 1 : jobs; }
+
+  /**
+   * Find an import next to a source directory or in a lib/ folder above it
+   * Results, including misses, are kept in ImportPathCache::global().
+   * @return The canonical path, or an empty string if there is none
    */
-  std::string resolveSource(const std::string &source,
-                            const std::string &sourcePath);
+  static std::string findInSourceTree(const std::string &importPath,
+                                      const std::string &sourceDir);
 
   /**
    * Get the list of resolved file paths (for debugging)
@@ -65,25 +90,48 @@ public:
   const std::vector<Diagnostic> &diagnostics() const { return diagnosticsData; }
 
   /**
-   * Source mapping structures
+   * Get the lines of the last merged source
    */
-  struct SourceLocation {
-    std::string filePath;
-    int lineNumber;
-  };
+  const std::vector<std::string_view> &mergedLines() const {
+    return mergedLinesData;
+  }
 
   /**
-   * Get the source map (merged line -> original location)
+   * Get the source map: the original location of merged line n at n - 1
    */
-  const std::map<int, SourceLocation> &sourceMap() const {
+  const std::vector<SourceMapEntry> &sourceMap() const {
     return sourceMapData;
   }
 
 private:
   /**
-   * Read file contents
+   * Clear the merged source, source map and diagnostics of the last run
+   */
+  void reset();
+
+  /**
+   * Map a file for the lifetime of the merged source
+   * Reports a diagnostic and returns empty text if it cannot be opened.
+   */
+  std::string_view mapFile(const std::string &path);
+
+  /**
+   * Keep a copy of text for the lifetime of the merged source
+   */
+  std::string_view ownText(std::string text);
+
+  /**
+   * Append a line to the merged source
+   */
+  void appendLine(std::string_view text, uint32_t fileSymbol = 0,
+                  uint32_t lineNumber = 0);
+
+  /**
+   * Merge a source and its imports, auto-loading the prelude if asked to
    */
-  std::string readFile(const std::string &path);
+  const std::vector<std::string_view> &merge(std::string_view source,
+                                             const std::string &sourcePath,
+                                             bool withPrelude);
 
   /**
    * Resolve an import path to an actual file path
@@ -93,23 +141,45 @@ private:
                                 const std::string &sourceFile);
 
   /**
-   * Process a single source, resolving imports recursively
+   * Find the file an import refers to without reporting failures
+   * Safe to call from several threads.
+   * @return The canonical path, or an empty string if there is none
+   */
+  std::string findImportPath(const std::string &importPath,
+                             const std::string &sourceFile) const;
+
+  /**
+   * Resolve and read every file reachable from the roots (path, source),
+   * one import level at a time on up to jobCount threads, so processSource()
+   * only assembles the preloaded files
+   */
+  void preloadImports(
+      const std::vector<std::pair<std::string, std::string_view>> &roots);
+
+  /**
+   * Append a single source to the merged lines, resolving imports recursively
    */
-  std::string processSource(const std::string &source,
-                            const std::string &sourcePath,
-                            std::set<std::string> &visited);
+  void processSource(std::string_view source, const std::string &sourcePath,
+                     std::set<std::string> &visited);
 
   /**
    * Check if a line is an import line and extract the import path
    * Returns empty string if not an import line
    */
-  std::string extractImportPath(const std::string &line);
+  static std::string extractImportPath(std::string_view line);
 
   std::string baseDir;
   std::vector<std::string> resolvedFilesData;
   std::vector<Diagnostic> diagnosticsData;
-  std::map<int, SourceLocation> sourceMapData;
-  int currentMergedLine = 0;
+  std::vector<std::string_view> mergedLinesData;
+  std::vector<SourceMapEntry> sourceMapData;
+  std::deque<MappedFile> mappedFiles; // Deque: mapped files never move
+  std::deque<std::string> ownedTexts; // Generated lines and copied sources
+  int jobCount = 1;
+  std::map<std::string, std::string_view>
+      preloadedFiles; // Canonical path -> mapped text
+  std::map<std::pair<std::string, std::string>, std::string>
+      preloadedPaths; // (source file, import) -> path, empty if not found
 };
 
 } // namespace tbx
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+
+namespace tbx {
+
+// Forward declaration
+struct ResolvedPattern;
+
+/**
+ * InfixOperator - One spelling of a binary expression pattern ($ op $)
+ *
+ * A pattern with alternatives, like "$ [is equal to|=] $", contributes one
+ * operator per spelling. Higher levels bind tighter.
+ */
+struct InfixOperator {
+  std::string spelling;               // Operator text with its spaces: " + "
+  ResolvedPattern *pattern = nullptr; // The expression pattern it belongs to
+  int level = 0;                      // Precedence level from priority:
+};
+
+} // namespace tbx
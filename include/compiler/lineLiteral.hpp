@@ -0,0 +1,46 @@
+#pragma once
+
+#include "compiler/lineLiteralType.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tbx {
+
+/**
+ * LineLiteral - A literal span of a CodeLine
+ *
+ * Stored as a span of the line text. Intrinsic calls also keep their name
+ * and their top-level arguments (trimmed, quotes kept), so later steps do not
+ * parse the call again.
+ */
+struct LineLiteral {
+  LineLiteralType type = LineLiteralType::String;
+  uint32_t start = 0;                     // Offset of the span in the text
+  uint32_t length = 0;                    // Length of the span in bytes
+  std::string intrinsicName;              // Name after @ (intrinsics only)
+  std::vector<std::string> intrinsicArgs; // Arguments (intrinsics only)
+
+  std::string_view view(std::string_view text) const {
+    return text.substr(start, length);
+  }
+};
+
+/**
+ * Find the string, number, intrinsic and group literals of a line, left to
+ * right. Literals do not overlap: the inside of an intrinsic call or a group
+ * is part of its span.
+ */
+std::vector<LineLiteral> detectLineLiterals(std::string_view text);
+
+/**
+ * Parse an intrinsic call @name(arg, ...) starting at startPos
+ * @return The position after the closing parenthesis, or std::string::npos
+ *         if there is no well-formed call at startPos
+ */
+size_t parseIntrinsicCall(std::string_view text, size_t startPos,
+                          std::string &name, std::vector<std::string> &args);
+
+} // namespace tbx
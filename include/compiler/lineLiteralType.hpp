@@ -0,0 +1,15 @@
+#pragma once
+
+namespace tbx {
+
+/**
+ * LineLiteralType - Kind of literal span found in a code line
+ */
+enum class LineLiteralType {
+  String,    // "..." or '...'
+  Number,    // 123, 3.14, -7
+  Intrinsic, // @name(...)
+  Group      // (...)
+};
+
+} // namespace tbx
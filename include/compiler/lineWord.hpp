@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace tbx {
+
+/**
+ * LineWord - One word of a CodeLine
+ *
+ * Words are separated by whitespace; a quoted string is a single word even
+ * if it contains spaces. The word is stored as a span of the line text plus
+ * its ID in SymbolTable::global().
+ */
+struct LineWord {
+  uint32_t start = 0;  // Offset of the word in the line text
+  uint32_t length = 0; // Length of the word in bytes
+  uint32_t symbol = 0; // Interned word
+
+  std::string_view view(std::string_view text) const {
+    return text.substr(start, length);
+  }
+};
+
+/**
+ * Split a line into interned words
+ */
+std::vector<LineWord> splitLineWords(std::string_view text);
+
+} // namespace tbx
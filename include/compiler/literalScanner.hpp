@@ -0,0 +1,63 @@
+#pragma once
+
+#include "compiler/literalScannerState.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace tbx {
+
+/**
+ * LiteralScanner - Aho-Corasick automaton over a set of words
+ *
+ * Finds every registered word that occurs in a text with a single pass over
+ * the text, however many words are registered. Words are added first, then
+ * build() links the automaton; scan() may be called concurrently afterwards.
+ */
+class LiteralScanner {
+public:
+  LiteralScanner();
+
+  /**
+   * Register a word
+   * @return The word's id; adding a word twice returns the same id
+   */
+  uint32_t addWord(const std::string &word);
+
+  /**
+   * Compute the failure and output links. Must be called after the last
+   * addWord() and before scan().
+   */
+  void build();
+
+  /**
+   * Find the distinct words that occur in a text
+   * @return Their ids, in order of first occurrence
+   */
+  std::vector<uint32_t> scan(std::string_view text) const;
+
+  /**
+   * Number of distinct registered words
+   */
+  size_t wordCount() const { return wordIds.size(); }
+
+  /**
+   * Remove all words
+   */
+  void clear();
+
+private:
+  /**
+   * Follow the transition for a byte, or return noState if there is none
+   */
+  uint32_t findTransition(uint32_t stateIndex, unsigned char byte) const;
+
+  // States of the automaton; the root (empty prefix) is at index 0
+  std::vector<LiteralScannerState> states;
+  std::unordered_map<std::string, uint32_t> wordIds;
+};
+
+} // namespace tbx
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace tbx {
+
+/**
+ * LiteralScannerState - A state of the LiteralScanner automaton
+ *
+ * Each state stands for the prefix of one or more words that has been read
+ * so far. Reading a byte without a transition falls back along the failure
+ * links to the longest suffix that is still a prefix of some word.
+ */
+struct LiteralScannerState {
+  // Index value meaning "no state"
+  static constexpr uint32_t noState = UINT32_MAX;
+
+  // Transitions keyed by the next byte, sorted by byte
+  std::vector<std::pair<unsigned char, uint32_t>> transitions;
+
+  // State of the longest proper suffix that is a prefix of some word
+  uint32_t failure = 0;
+
+  // Nearest state along the failure links that completes a word
+  uint32_t outputLink = noState;
+
+  // Word this state completes, or noState
+  uint32_t word = noState;
+};
+
+} // namespace tbx
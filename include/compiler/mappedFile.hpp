@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace tbx {
+
+/**
+ * MappedFile - A source file memory-mapped read-only
+ *
+ * The text stays valid, without being copied, for the lifetime of the object,
+ * so views into it can stand in for the file contents. Empty files are not
+ * mapped and have empty text.
+ */
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  /**
+   * Map a file, replacing any file mapped before
+   * @return false if the file cannot be opened or mapped
+   */
+  bool open(const std::string &path);
+
+  std::string_view text() const { return {data, size}; }
+
+private:
+  void close();
+
+  const char *data = nullptr;
+  size_t size = 0;
+};
+
+} // namespace tbx
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "compiler/infixOperator.hpp"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tbx {
+
+/**
+ * OperatorPrecedenceTable - Precedence-based splitting of infix expressions
+ *
+ * Holds every spelling of the binary expression patterns ($ op $) with the
+ * precedence level compiled from their priority: directives. Instead of
+ * trying every operand boundary in the pattern tree, an expression is split
+ * in one scan at its loosest-binding top-level operator. Equal levels
+ * associate to the left, so the rightmost of them is the split point.
+ */
+class OperatorPrecedenceTable {
+public:
+  /**
+   * Register one operator spelling
+   */
+  void addOperator(InfixOperator infixOperator);
+
+  /**
+   * Remove all operators
+   */
+  void clear();
+
+  /**
+   * Check whether any operators are registered
+   */
+  bool empty() const { return operators.empty(); }
+
+  /**
+   * Extract the operator spelling from one expanded pattern variant
+   * @return The spelling (" + " for "$ + $"), or "" if the variant is not a
+   *         plain binary pattern
+   */
+  static std::string infixSpelling(const std::string &variant);
+
+  /**
+   * Find the operator an expression splits at: the lowest level wins, then
+   * the rightmost position, then the longest spelling. Operators inside
+   * parentheses, brackets or quotes are ignored, and both operands must be
+   * non-empty.
+   * @param input The expression text
+   * @param startPos Where the expression starts in input
+   * @param operatorPos Output: position of the operator spelling in input
+   * @return The operator, or nullptr if no operator applies
+   */
+  const InfixOperator *findSplit(const std::string &input, size_t startPos,
+                                 size_t &operatorPos) const;
+
+private:
+  std::vector<InfixOperator> operators;
+
+  // Operator indices keyed by the byte after their leading space (every
+  // spelling starts with one), so each position only checks a few spellings
+  std::array<std::vector<uint32_t>, 256> operatorsBySecondByte;
+};
+
+} // namespace tbx
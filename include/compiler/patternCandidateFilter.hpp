@@ -0,0 +1,70 @@
+#pragma once
+
+#include "compiler/literalScanner.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tbx {
+
+/**
+ * PatternCandidateFilter - Pre-filter for PatternTree::match()
+ *
+ * Every pattern is registered with the words it always contains literally.
+ * One LiteralScanner pass over a line finds which of those words occur in
+ * it; a pattern is a candidate when all of its words do. A pattern that is
+ * not a candidate cannot match the line.
+ */
+class PatternCandidateFilter {
+public:
+  /**
+   * Register a pattern. Patterns without words are always candidates.
+   * @param slot The pattern's bit index in candidate sets
+   * @param words Words the pattern always contains
+   */
+  void addPattern(size_t slot, const std::vector<std::string> &words);
+
+  /**
+   * Link the word scanner. Must be called after the last addPattern().
+   */
+  void build();
+
+  /**
+   * Bit set (by slot) of all patterns whose words all occur in a text
+   */
+  std::vector<uint64_t> candidates(std::string_view text) const;
+
+  /**
+   * Remove all patterns
+   */
+  void clear();
+
+  /**
+   * Candidate set helpers: a set is a bit vector indexed by slot, grown on
+   * demand. addSlot() sets one bit, mergeSlots() adds all bits of another
+   * set, and sharesSlot() checks whether two sets have a bit in common.
+   */
+  static void addSlot(std::vector<uint64_t> &bits, size_t slot);
+  static void mergeSlots(std::vector<uint64_t> &bits,
+                         const std::vector<uint64_t> &other);
+  static bool sharesSlot(const std::vector<uint64_t> &bits,
+                         const std::vector<uint64_t> &other);
+
+private:
+  LiteralScanner scanner;
+
+  // Patterns (by registration index) containing each word (by word id)
+  std::vector<std::vector<uint32_t>> patternsByWord;
+
+  // Slot and number of distinct words of each registered pattern
+  std::vector<size_t> patternSlots;
+  std::vector<uint32_t> patternWordCounts;
+
+  // Slots of the patterns without words
+  std::vector<uint64_t> unconditionalPatterns;
+};
+
+} // namespace tbx
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace tbx {
+
+/**
+ * PatternPathCursor - A point reached while walking a pattern's tokens
+ * through the tree
+ *
+ * Besides the node and token position, the cursor carries the state the
+ * element parser would have at this point of an expanded variant, so every
+ * branch produces exactly the elements of the variants it stands for.
+ * Literals are cut at the end of each [a|b] group, so the branches can meet
+ * in a shared node.
+ */
+struct PatternPathCursor {
+  uint32_t node = 0;
+  size_t position = 0;           // Index of the next token
+  std::string literal;           // Literal text not yet turned into an edge
+  std::string leadingSpaces;     // Spaces skipped at the start of the variant
+  bool atStart = true;           // Nothing but spaces seen so far
+  bool skipSpace = false;        // Previous element was a capture; skip a ' '
+  bool afterCapture = false;     // Last edge is a capture
+  bool literalOpen = false;      // Last edge is a literal cut at a group end
+  bool openLiteralSpace = false; // That literal ends with ' '
+
+  /**
+   * Check whether two cursors have the same parser state (node aside), so
+   * the rest of the pattern produces the same elements from both
+   */
+  bool sameState(const PatternPathCursor &other) const {
+    return position == other.position && literal == other.literal &&
+           leadingSpaces == other.leadingSpaces &&
+           atStart == other.atStart && skipSpace == other.skipSpace &&
+           afterCapture == other.afterCapture &&
+           literalOpen == other.literalOpen &&
+           openLiteralSpace == other.openLiteralSpace;
+  }
+};
+
+} // namespace tbx
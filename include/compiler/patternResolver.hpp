@@ -2,12 +2,16 @@
 
 #include "compiler/patternMatch.hpp"
 #include "compiler/patternTree.hpp"
+#include "compiler/patternVariableIndex.hpp"
 #include "compiler/resolvedPattern.hpp"
 #include "compiler/sectionAnalyzer.hpp"
 #include <map>
 #include <memory>
 #include <optional>
+#include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <variant>
 #include <vector>
 
@@ -26,11 +30,18 @@ class SectionPatternResolver {
 public:
   SectionPatternResolver();
 
+  /**
+   * Set how many threads match lines during each resolve iteration
+   * (1 = match on the calling thread). Results do not depend on it.
+   */
+  void setJobCount(int jobs) { jobCount = jobs < 1 ? 1 : jobs; }
+
   /**
    * Resolve all pattern references in the section tree
+   * @param sections Arena holding the tree (see SectionAnalyzer::analyze())
    * @return true if all patterns were successfully resolved
    */
-  bool resolve(Section *root);
+  bool resolve(SectionArena &sections);
 
   /**
    * Get any diagnostics (errors/warnings) found during resolution
@@ -59,10 +70,23 @@ public:
 
   /**
    * Tree-based matching (Step 3 optimized)
+   * buildPatternTrees() rebuilds all trees from scratch; updatePatternTrees()
+   * only applies patterns queued since the last update and returns the ones
+   * that changed a tree.
    */
   void buildPatternTrees();
+  std::vector<ResolvedPattern *> updatePatternTrees();
   PatternMatch *matchWithTree(CodeLine *line);
 
+  /**
+   * Split form of matchWithTree(): findTreeMatch() only reads the pattern
+   * trees, so it may run on several lines concurrently; commitTreeMatch()
+   * records the result and must run on one thread.
+   */
+  std::optional<TreePatternMatch> findTreeMatch(const CodeLine *line);
+  PatternMatch *commitTreeMatch(CodeLine *line,
+                                const TreePatternMatch &treeMatch);
+
   /**
    * Get the pattern match for a specific code line
    */
@@ -81,7 +105,6 @@ private:
    * Phase 1: Collect all pattern definitions and code lines
    */
   void collectCodeLines(Section *section, std::vector<CodeLine *> &lines);
-  void collectSections(Section *section, std::vector<Section *> &sections);
   std::vector<std::unique_ptr<ResolvedPattern>>
   extractPatternDefinitions(CodeLine *line);
   std::unique_ptr<ResolvedPattern> extractPatternDefinition(CodeLine *line);
@@ -103,8 +126,52 @@ private:
    */
   void resolveSingleWordPatterns();
   bool resolvePatternReferences();
+
+  /**
+   * Run findTreeMatch() for every line, on up to jobCount threads. Result i
+   * belongs to lines[i].
+   */
+  std::vector<std::optional<TreePatternMatch>>
+  findTreeMatches(const std::vector<CodeLine *> &lines);
   bool resolveSections();
   bool propagateVariablesFromCalls();
+  bool propagateVariablesToPattern(size_t patternIndex);
+
+  /**
+   * Identifiers (maximal runs of letters, digits and _) of each string
+   * argument of a match, in argument order. Computed on first use; a match
+   * never changes once recorded.
+   */
+  const std::vector<std::unordered_set<std::string>> &
+  argumentIdentifiers(const PatternMatch *match);
+
+  /**
+   * Resolution worklists. Each iteration only retries lines that could match
+   * a pattern the trees gained or changed, only re-checks sections one of
+   * whose lines resolved, and only re-propagates variables for patterns whose
+   * body gained a match.
+   */
+  void initializeWorklists();
+  std::vector<CodeLine *>
+  linesToRetry(const std::vector<ResolvedPattern *> &changedPatterns);
+  void markLineResolved(const CodeLine *line);
+  void markLineMatched(const CodeLine *line);
+
+  /**
+   * Compile priority: directives into the expression tree's operator
+   * precedence table. Each pattern's level is its target's level plus one
+   * ("before") or minus one ("after"); patterns without a directive are at
+   * level 0. Targets are resolved before the patterns that refer to them.
+   * A body with several directives and a cycle of directives are reported
+   * as errors.
+   */
+  void buildOperatorTable();
+  int priorityLevel(ResolvedPattern *pattern,
+                    std::map<ResolvedPattern *, int> &levels);
+  void reportPriorityError(const std::string &message, const CodeLine *line);
+  bool parsePriorityDirective(const ResolvedPattern *pattern,
+                              bool &bindsTighter, std::string &target) const;
+  ResolvedPattern *findPriorityTarget(const std::string &target) const;
 
   /**
    * Helper to detect if a line is a special directive or intrinsic
@@ -115,20 +182,8 @@ private:
   bool isInsidePatternsSection(CodeLine *line) const;
 
   /**
-   * Tree-based matching helper structures and methods
+   * Tree-based matching helper methods
    */
-  struct ParsedLiteral {
-    enum class Type { String, Number, Intrinsic, Group };
-    Type type;
-    std::string text;
-    size_t startPos;
-    size_t endPos;
-    std::vector<std::string> intrinsicArgs;
-  };
-
-  std::vector<ParsedLiteral> detectLiterals(const std::string &input);
-  size_t parseIntrinsicCall(const std::string &input, size_t startPos,
-                            std::string &name, std::vector<std::string> &args);
   std::unique_ptr<PatternMatch>
   treeMatchToPatternMatch(const TreePatternMatch &treeMatch,
                           const ResolvedPattern *pattern);
@@ -139,10 +194,30 @@ private:
 
   // Working state during resolution
   std::vector<CodeLine *> allLinesData;
-  std::vector<Section *> allSectionsData;
+  std::vector<Section *> allSectionsData; // In pre-order, by Section::index
   std::map<CodeLine *, ResolvedPattern *> lineToPatternData;
   std::map<CodeLine *, PatternMatch *> lineToMatchData;
 
+  // Threads used for line matching
+  int jobCount = 1;
+
+  // Patterns whose resolution state or pattern string may have changed since
+  // the trees were last updated
+  std::vector<ResolvedPattern *> pendingTreeUpdates;
+
+  // Worklists (see initializeWorklists). Sections and patterns are kept as
+  // indices into allSectionsData / patternDefinitionsData so they are visited
+  // in the same order a full sweep would visit them.
+  std::vector<CodeLine *> unresolvedLines;
+  bool retryAllLines = false;
+  std::set<size_t> dirtySections;
+  std::set<size_t> dirtyPatterns;
+  std::unordered_map<const Section *, std::vector<size_t>> patternsByBody;
+  std::vector<PatternVariableIndex> variableIndices; // By pattern index
+  std::unordered_map<const PatternMatch *,
+                     std::vector<std::unordered_set<std::string>>>
+      matchIdentifiers;
+
   // Pattern Trees
   PatternTree effectTree;
   PatternTree sectionTree;
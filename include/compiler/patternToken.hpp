@@ -0,0 +1,28 @@
+#pragma once
+
+#include "compiler/patternElement.hpp"
+#include "compiler/patternTokenType.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace tbx {
+
+/**
+ * PatternToken - One step of a pattern string with its [a|b] groups kept
+ *
+ * A pattern is inserted by walking its tokens rather than its expanded
+ * variants: a group sends the walk into each alternative and the
+ * alternatives meet again at the closing bracket, so the tree grows with the
+ * sum of the alternatives instead of their product.
+ */
+struct PatternToken {
+  PatternTokenType type = PatternTokenType::Character;
+  char character = 0;          // For Character tokens
+  std::vector<size_t> targets; // Token indices a group or alternative jumps to
+
+  // For Capture tokens: the $ slot or capture element
+  PatternElement capture = {PatternElementType::Variable, "", ""};
+};
+
+} // namespace tbx
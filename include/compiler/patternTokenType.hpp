@@ -0,0 +1,16 @@
+#pragma once
+
+namespace tbx {
+
+/**
+ * Kinds of tokens a pattern string is split into for insertion
+ */
+enum class PatternTokenType {
+  Character,      // One character of literal text
+  Capture,        // A $ slot or {type:name} capture
+  GroupOpen,      // [ - continues at the start of every alternative
+  AlternativeEnd, // | - jumps to the ] of its group
+  GroupClose      // ] - where the alternatives of a group meet again
+};
+
+} // namespace tbx
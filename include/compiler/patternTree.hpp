@@ -2,13 +2,27 @@
 
 #include "compiler/expressionMatch.hpp"
 #include "compiler/matchedValue.hpp"
+#include "compiler/operatorPrecedenceTable.hpp"
+#include "compiler/patternCandidateFilter.hpp"
 #include "compiler/patternElement.hpp"
 #include "compiler/patternElementType.hpp"
+#include "compiler/pendingArgument.hpp"
+#include "compiler/patternPathCursor.hpp"
+#include "compiler/patternToken.hpp"
+#include "compiler/patternTreeEntry.hpp"
 #include "compiler/patternTreeNode.hpp"
+#include "compiler/patternWalk.hpp"
+#include "compiler/treeMatchSearch.hpp"
 #include "compiler/treePatternMatch.hpp"
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace tbx {
@@ -19,11 +33,25 @@ struct ResolvedPattern;
 /**
  * PatternTree - Trie-like structure for efficient pattern matching
  *
+ * Nodes are stored in a flat arena (root at index 0) and linked by index, so
+ * clear() releases the whole tree at once.
+ *
  * Supports:
  * - Merged literal sequences for compact storage
  * - Expression substitution via recursive matching
- * - Alternatives [a|b] with branch-and-merge (handled during pattern insertion)
+ * - Alternatives [a|b] with branch-and-merge (handled during pattern
+ *   insertion): the branches of a group meet in a shared node, so a
+ *   pattern with many groups does not expand into one path per combination
  * - Lazy captures {word} for deferred evaluation
+ * - Copy-free search: arguments are views on one shared stack until a match
+ *   is recorded
+ * - Branch-and-bound best-match search using per-node specificity bounds
+ * - Literal pre-filter: one Aho-Corasick scan per line finds the patterns
+ *   whose required words all occur in it, and match() only enters subtrees
+ *   leading to one of them
+ * - Precedence-based splitting of binary ($ op $) expressions
+ * - Concurrent match()/matchExpression() calls once the tree is built
+ * - Incremental insert/remove/replace of individual patterns
  */
 class PatternTree {
 public:
@@ -31,10 +59,32 @@ public:
 
   /**
    * Add a pattern to the tree
+   * If the pattern is already present, its old paths are replaced.
    * @param pattern The resolved pattern to add
    */
   void addPattern(ResolvedPattern *pattern);
 
+  /**
+   * Remove a pattern from the tree, using the pattern string it was added with
+   * @param pattern The resolved pattern to remove
+   */
+  void removePattern(ResolvedPattern *pattern);
+
+  /**
+   * Add a pattern, or replace it if its pattern string changed since it was
+   * added
+   * @param pattern The resolved pattern to insert or refresh
+   * @return true if the tree changed
+   */
+  bool updatePattern(ResolvedPattern *pattern);
+
+  /**
+   * Check whether a pattern is currently in the tree
+   */
+  bool contains(const ResolvedPattern *pattern) const {
+    return patternEntries.count(pattern) != 0;
+  }
+
   /**
    * Match input text against all patterns in the tree
    * @param input The input text to match
@@ -46,6 +96,8 @@ public:
 
   /**
    * Match only expression patterns (for expression substitution)
+   * Binary expressions are split by the operator table first; other patterns
+   * only win over that split if they are more specific.
    * @param input The input text to match
    * @param startPos Starting position in the input
    * @return Best expression match, or nullopt if no match
@@ -53,17 +105,56 @@ public:
   std::optional<TreePatternMatch> matchExpression(const std::string &input,
                                                   size_t startPos = 0);
 
+  /**
+   * Install the operator precedence table used by matchExpression()
+   */
+  void setOperatorTable(OperatorPrecedenceTable table) {
+    operatorTable = std::move(table);
+  }
+
   /**
    * Clear all patterns from the tree
    */
   void clear();
 
+  /**
+   * Words every expansion of a pattern string contains literally (text outside
+   * [alternatives], $ slots and {captures}). A line that lacks one of them
+   * cannot match the pattern.
+   */
+  static std::vector<std::string>
+  requiredLiteralWords(const std::string &patternText);
+
+  /**
+   * Number of tree nodes visited by matching since construction (for
+   * benchmarking)
+   */
+  size_t nodesVisited() const { return nodesVisitedCount.load(); }
+
+  /**
+   * Number of nodes currently in the tree (for benchmarking)
+   */
+  size_t nodeCount() const { return nodes.size() - freeNodes.size(); }
+
   /**
    * Get the root node (for debugging)
    */
-  const PatternTreeNode &root() const { return rootNode; }
+  const PatternTreeNode &root() const { return nodes[rootIndex]; }
 
 private:
+  /**
+   * Compile an expression pattern into its own single-path tree, used by
+   * matchExpression(). Built once per pattern when it is added.
+   */
+  std::unique_ptr<PatternTree>
+  compileExpressionPattern(ResolvedPattern *pattern);
+
+  /**
+   * Expand a pattern string into the element paths it occupies in the tree
+   */
+  std::vector<std::vector<PatternElement>>
+  expandPatternPaths(const std::string &patternText);
+
   /**
    * Parse a pattern into elements (merged literals + variable slots)
    */
@@ -76,43 +167,178 @@ private:
   std::vector<PatternElement>
   parsePatternElementsFromString(const std::string &text);
 
+  /**
+   * Build the capture element for the text between { and }
+   */
+  static PatternElement parseCaptureElement(const std::string &captureContent);
+
   /**
    * Parse alternatives in a pattern text
    * Returns expanded patterns for [a|b] syntax
    */
   std::vector<std::string> expandAlternatives(const std::string &patternText);
 
+  /**
+   * Split a pattern string into tokens, keeping its [a|b] groups
+   * @return false if the string cannot be walked group by group (unbalanced
+   *         brackets, or a {capture} spanning a group boundary); such patterns
+   *         are inserted as expanded paths instead
+   */
+  static bool parsePatternTokens(const std::string &text,
+                                 std::vector<PatternToken> &tokens);
+
+  /**
+   * Add a pattern as one walk over its tokens: every [a|b] group branches
+   * and the branches merge again afterwards, so the tree grows with the sum
+   * of the alternatives rather than their product
+   */
+  void addPatternGraph(const std::vector<PatternToken> &tokens,
+                       ResolvedPattern *pattern);
+
+  /**
+   * Remove a pattern added by addPatternGraph(), pruning nodes left empty
+   */
+  void removePatternGraph(const std::vector<PatternToken> &tokens,
+                          ResolvedPattern *pattern);
+
+  /**
+   * Walk a pattern's tokens through the tree. Cursors are advanced lowest
+   * token position first, so all branches of a group have arrived before
+   * its closing bracket is processed.
+   * @return The distinct nodes the pattern's variants end at
+   */
+  std::vector<uint32_t> walkPattern(const std::vector<PatternToken> &tokens,
+                                    PatternWalk &walk);
+
+  /**
+   * Move the cursors at the current token along the element each emits
+   * (cursors without one stay put) and queue them again. Cursors must already
+   * hold their state after the step; cursors that end up in the same state
+   * step into shared children. A shared child is copied before a subset of
+   * its parents continues from it, and every queued cursor at that child is
+   * duplicated onto the copy.
+   */
+  void stepFrontier(std::vector<PatternPathCursor> &current,
+                    std::vector<std::optional<PatternElement>> &emitted,
+                    std::vector<PatternPathCursor> &pending,
+                    PatternWalk &walk);
+
   /**
    * Add a single expanded pattern path to the tree
    */
   void addPatternPath(const std::vector<PatternElement> &elements,
                       ResolvedPattern *pattern);
 
+  /**
+   * Node arena helpers. findChild() returns PatternTreeNode::noNode when the
+   * element has no child yet; addChild() creates it. linkChild() points the
+   * element's edge at a given node; unlinkChild() removes every edge from a
+   * node to a child and frees the child once nothing leads to it (only done
+   * for empty children). cloneNode() copies a node, sharing its children.
+   */
+  uint32_t allocateNode();
+  uint32_t findChild(uint32_t nodeIndex, const PatternElement &elem) const;
+  uint32_t addChild(uint32_t nodeIndex, const PatternElement &elem);
+  void linkChild(uint32_t nodeIndex, const PatternElement &elem,
+                 uint32_t child);
+  bool unlinkChild(uint32_t nodeIndex, uint32_t child);
+  uint32_t cloneNode(uint32_t nodeIndex);
+
+  /**
+   * Recompute a node's maxSpecificity and patternMask from its own patterns
+   * and children
+   * @return true if either changed
+   */
+  bool refreshBounds(uint32_t nodeIndex);
+
+  /**
+   * Set the bit of an insertion rank in a node's patternMask. Patterns that
+   * are not in the tree (precompiled expression paths) have no rank and are
+   * left out; those trees are only searched without a candidate filter.
+   */
+  static void addPatternSlot(std::vector<uint64_t> &mask, size_t order);
+
+  /**
+   * Rebuild the candidate filter from the patterns in the tree if they
+   * changed since it was last built. Safe to call from concurrent match()
+   * calls.
+   */
+  void refreshCandidateFilter();
+
+  /**
+   * Remove a pattern from the end of a path, pruning nodes left empty
+   */
+  void removePatternPath(const std::vector<PatternElement> &elements,
+                         ResolvedPattern *pattern);
+
+  /**
+   * Insertion rank of a pattern (patterns not in the tree sort last)
+   */
+  size_t patternOrder(const ResolvedPattern *pattern) const;
+
   /**
    * Internal matching with backtracking
-   * @param node Current node in the tree
+   * @param nodeIndex Arena index of the current node
    * @param input Input text
    * @param pos Current position in input
-   * @param arguments Collected arguments so far
-   * @param matches Output: all successful matches found
+   * @param arguments Argument stack shared by all branches; each branch
+   *                  pushes its capture and pops it again before returning
+   * @param search In/out: best match so far, used to prune the search
    */
-  void matchRecursive(PatternTreeNode *node, const std::string &input,
-                      size_t pos, std::vector<MatchedValue> &arguments,
-                      std::vector<TreePatternMatch> &matches);
+  void matchRecursive(uint32_t nodeIndex, const std::string &input,
+                      size_t pos, std::vector<PendingArgument> &arguments,
+                      TreeMatchSearch &search);
 
   /**
-   * Try to match an expression at the current position
-   * Used when encountering an expression_child node
+   * Recurse into a child with one more argument on the shared stack
+   */
+  void matchWithArgument(uint32_t nodeIndex, const std::string &input,
+                         size_t pos, PendingArgument argument,
+                         std::vector<PendingArgument> &arguments,
+                         TreeMatchSearch &search);
+
+  /**
+   * Check whether anything below a node could beat the current best match:
+   * a candidate pattern with higher specificity, or equal specificity with
+   * more input consumed
+   */
+  static bool canImproveOn(const PatternTreeNode &node,
+                           const TreeMatchSearch &search,
+                           const std::string &input);
+
+  /**
+   * Record a complete match if it beats the current best. Earlier matches
+   * win ties, so the result is the same as ranking every match.
+   */
+  static void recordMatch(ResolvedPattern *pattern, size_t pos,
+                          const std::vector<PendingArgument> &arguments,
+                          TreeMatchSearch &search);
+
+  /**
+   * Copy pending arguments into owned values for a recorded match
+   */
+  static std::vector<MatchedValue>
+  materializeArguments(const std::vector<PendingArgument> &arguments);
+
+  /**
+   * Split an expression at its loosest binary operator, as a full-length
+   * match of that operator's pattern
    */
-  std::optional<ExpressionMatch> tryMatchExpressionAt(const std::string &input,
-                                                      size_t pos);
+  std::optional<TreePatternMatch> matchInfix(const std::string &input,
+                                             size_t startPos);
 
   /**
-   * Find possible expression end positions
-   * Returns positions in reverse order (longest first) for greedy matching
+   * Owned argument value for an operand: a literal if it parses as one,
+   * otherwise the text itself
    */
-  std::vector<size_t> findExpressionBoundaries(const std::string &input,
-                                               size_t start);
+  MatchedValue operandValue(std::string_view text);
+
+  /**
+   * Try to match an expression at the current position
+   * Used when encountering an expression_child node
+   */
+  std::shared_ptr<ExpressionMatch>
+  tryMatchExpressionAt(const std::string &input, size_t pos);
 
   /**
    * Check if a character is an expression boundary
@@ -122,12 +348,35 @@ private:
   /**
    * Try to parse a literal value (number or string)
    */
-  std::optional<MatchedValue> tryParseLiteral(const std::string &text);
+  std::optional<PendingArgument> tryParseLiteral(std::string_view text);
+
+  static constexpr uint32_t rootIndex = 0;
 
-  PatternTreeNode rootNode;
+  // Node arena; nodes released by removePattern() are reused via freeNodes
+  std::vector<PatternTreeNode> nodes;
+  std::vector<uint32_t> freeNodes;
 
   // Separate storage for expression patterns (for recursive matching)
   std::vector<ResolvedPattern *> expressionPatterns;
+
+  // Precompiled path for each entry of expressionPatterns (same order)
+  std::vector<std::unique_ptr<PatternTree>> expressionPatternTrees;
+
+  // Patterns in the tree, with the pattern string each was added with
+  std::unordered_map<const ResolvedPattern *, PatternTreeEntry> patternEntries;
+  size_t nextPatternOrder = 0;
+
+  // Binary operator precedence, compiled from priority: directives
+  OperatorPrecedenceTable operatorTable;
+
+  // Required words of every pattern, rebuilt lazily by the first match()
+  // after the patterns change
+  PatternCandidateFilter candidateFilter;
+  std::atomic<bool> candidateFilterStale{false};
+  std::mutex candidateFilterMutex;
+
+  // Nodes entered by matchRecursive, including precompiled expression paths
+  std::atomic<size_t> nodesVisitedCount{0};
 };
 
 } // namespace tbx
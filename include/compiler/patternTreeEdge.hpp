@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace tbx {
+
+/**
+ * PatternTreeEdge - Literal transition between two pattern tree nodes
+ *
+ * Stored in the parent's children array, sorted by literal, and pointing at
+ * the child by its index in the owning PatternTree's node arena.
+ */
+struct PatternTreeEdge {
+  std::string literal; // Merged literal sequence consumed by this edge
+  uint32_t child = 0;  // Arena index of the child node
+};
+
+} // namespace tbx
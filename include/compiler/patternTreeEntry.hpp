@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace tbx {
+
+/**
+ * PatternTreeEntry - Bookkeeping for a pattern stored in a PatternTree
+ *
+ * Remembers the pattern string the paths were built from, so the pattern can
+ * be removed after its ResolvedPattern::pattern has been rewritten, and the
+ * order the pattern was first added in, so replaced patterns keep their place
+ * among patterns ending at the same node.
+ */
+struct PatternTreeEntry {
+  size_t order = 0;            // Insertion rank, kept across replacements
+  std::string insertedPattern; // Pattern string the tree paths came from
+};
+
+} // namespace tbx
@@ -1,8 +1,9 @@
 #pragma once
 
-#include <memory>
-#include <string>
-#include <unordered_map>
+#include "compiler/patternTreeEdge.hpp"
+
+#include <bitset>
+#include <cstdint>
 #include <vector>
 
 namespace tbx {
@@ -13,26 +14,55 @@ struct ResolvedPattern;
 /**
  * PatternTreeNode - A node in the pattern matching trie
  *
- * Uses unordered_map for O(1) child lookup by literal string.
- * Separate pointers for different capture types.
+ * Nodes live in a flat arena owned by their PatternTree and refer to each
+ * other by index. Literal children are kept in a contiguous array sorted by
+ * literal; capture children are single index links. Alternatives make the
+ * tree a DAG: a node may be reached through several edges.
  */
 struct PatternTreeNode {
-  // Child nodes keyed by literal strings (merged sequences)
-  std::unordered_map<std::string, std::shared_ptr<PatternTreeNode>> children;
+  // Index value meaning "no child"
+  static constexpr uint32_t noNode = UINT32_MAX;
+
+  // Child nodes keyed by literal strings (merged sequences), sorted by literal
+  std::vector<PatternTreeEdge> children;
+
+  // First byte of every literal child, for rejecting input bytes that no
+  // child can start with. Children sharing a first byte are adjacent.
+  std::bitset<256> literalFirstBytes;
 
   // Child node for expression variable slots ($) - eager evaluation
-  std::shared_ptr<PatternTreeNode> expressionChild;
+  uint32_t expressionChild = noNode;
 
   // Child node for {expression:name} - lazy capture (greedy, caller's scope)
-  std::shared_ptr<PatternTreeNode> expressionCaptureChild;
+  uint32_t expressionCaptureChild = noNode;
 
   // Child node for {word:name} - single identifier capture (non-greedy)
-  std::shared_ptr<PatternTreeNode> wordCaptureChild;
+  uint32_t wordCaptureChild = noNode;
 
   // Patterns that end at this node
   std::vector<ResolvedPattern *> patternsEndedHere;
 
+  // Highest specificity of any pattern ending at or below this node (-1 if
+  // none). Upper bound used to prune the best-match search.
+  int maxSpecificity = -1;
+
+  // Bit per insertion rank of the patterns ending at or below this node.
+  // Subtrees sharing no bit with a line's candidate patterns cannot match it.
+  std::vector<uint64_t> patternMask;
+
+  // Number of edges leading here. Branches of an [a|b] group merge into one
+  // node, so a node can have several parents; it is copied before another
+  // pattern's path continues from it through just one of them.
+  uint32_t parentCount = 0;
+
   PatternTreeNode() = default;
+
+  // Check whether the node has no children and no patterns ending here
+  bool isEmpty() const {
+    return children.empty() && patternsEndedHere.empty() &&
+           expressionChild == noNode && expressionCaptureChild == noNode &&
+           wordCaptureChild == noNode;
+  }
 };
 
 } // namespace tbx
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace tbx {
+
+/**
+ * PatternVariableIndex - Cached lookups for variable propagation
+ *
+ * Built once per pattern definition before the resolver's fixpoint loop, so
+ * propagation does not re-split the pattern text or scan the variable list
+ * on every iteration.
+ */
+struct PatternVariableIndex {
+  std::vector<std::string> originalWords;    // Words of originalText
+  std::vector<std::string> wordIdentifiers;  // Leading identifier of each word
+  std::unordered_set<std::string> variables; // Same names as ->variables
+};
+
+} // namespace tbx
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace tbx {
+
+/**
+ * PatternWalk - Options and record of one walk of a pattern through the tree
+ *
+ * An inserting walk creates missing nodes (and copies shared ones before
+ * diverging from them); a non-inserting walk only follows existing edges, so
+ * removal can find every node the pattern occupies.
+ */
+struct PatternWalk {
+  bool insert = false;
+  std::vector<std::pair<uint32_t, uint32_t>> edges; // (parent, child) followed
+};
+
+} // namespace tbx
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <variant>
+
+namespace tbx {
+
+// Forward declaration
+struct ExpressionMatch;
+
+/**
+ * An argument captured while a PatternTree is still searching
+ *
+ * Text is kept as a view into the line being matched; it only becomes an
+ * owned MatchedValue once a complete match is recorded.
+ */
+using PendingArgument =
+    std::variant<int64_t,          // Integer literal
+                 double,           // Float literal
+                 std::string_view, // String literal or identifier (unowned)
+                 std::shared_ptr<ExpressionMatch> // Nested expression
+                 >;
+
+} // namespace tbx
@@ -3,24 +3,31 @@
 #include "compiler/codeLine.hpp"
 #include "compiler/resolvedValue.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
 
 namespace tbx {
 
+class SectionArena;
+
 /**
  * Section - A block of code at a particular indentation level
  *
  * Sections contain code lines, and each code line can have a child section.
- * This creates a tree structure based on indentation.
+ * This creates a tree structure based on indentation. Sections are owned by
+ * the SectionArena of their compilation.
  */
 struct Section {
   std::vector<CodeLine> lines;
   bool isResolved = false;
-  std::map<std::string, ResolvedValue> resolvedVariables;
+  std::map<uint32_t, ResolvedValue> resolvedVariables; // By interned name
   Section *parent = nullptr;
+  size_t parentLineIndex = 0; // Index of the owning line in parent->lines
   int indentLevel = 0;
+  uint32_t index = 0; // Pre-order position in the SectionArena
 
   // Default constructor
   Section() = default;
@@ -34,7 +41,8 @@ struct Section {
   Section &operator=(const Section &) = delete;
 
   /**
-   * Add a code line to this section
+   * Add a code line to this section, linking it (and its child section, if
+   * any) back to this section
    */
   void addLine(CodeLine line);
 
@@ -43,6 +51,12 @@ struct Section {
    */
   bool allLinesResolved() const;
 
+  /**
+   * Append deep copies of this section's lines to target, creating copies of
+   * their child sections in arena
+   */
+  void cloneLinesInto(Section &target, SectionArena &arena) const;
+
   /**
    * Print the section tree for debugging
    */
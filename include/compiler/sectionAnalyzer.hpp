@@ -5,10 +5,14 @@
 #include "compiler/patternType.hpp"
 #include "compiler/resolvedValue.hpp"
 #include "compiler/section.hpp"
+#include "compiler/sectionArena.hpp"
+#include "compiler/sectionSubtree.hpp"
+#include "compiler/sectionSubtreeCache.hpp"
+#include "compiler/sourceMapEntry.hpp"
 
-#include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace tbx {
@@ -17,6 +21,8 @@ namespace tbx {
  * SectionAnalyzer - Step 2 of the 3BX compiler pipeline
  *
  * Analyzes merged source code and creates a section tree based on indentation.
+ * With a source map, each run of lines from one file is analyzed on its own
+ * and the subtrees are spliced into the root section.
  *
  * Key principles:
  * - NO hardcoded keywords
@@ -29,78 +35,104 @@ class SectionAnalyzer {
 public:
   /**
    * Analyze source code and create section tree
-   * @param source The merged source code
-   * @param sourceMap Optional map mapping merged line numbers to original file
-   * locations (mergedLine -> {filePath, originalLine})
-   * @return Root section containing the entire program
+   * @param lines The lines of the merged source code
+   * @param sourceMap Optional original location of each merged line, at index
+   * line - 1 (see ImportResolver::sourceMap())
+   * @return Arena holding the section tree; its root contains the entire
+   * program
    */
-  struct SourceLocation {
-    std::string filePath;
-    int lineNumber;
-  };
-
-  std::unique_ptr<Section>
-  analyze(const std::string &source,
-          const std::map<int, SourceLocation> &sourceMap = {});
+  SectionArena
+  analyze(const std::vector<std::string_view> &lines,
+          const std::vector<SourceMapEntry> &sourceMap = {});
 
   /**
    * Get any errors that occurred during analysis
    */
   const std::vector<Diagnostic> &diagnostics() const { return diagnosticsData; }
 
+  /**
+   * Set the number of threads the file runs are analyzed on
+   */
+  void setJobCount(int jobs) { jobCount = jobs < 1 ? 1 : jobs; }
+
+  /**
+   * Reuse the subtrees of unchanged file runs from earlier analyses
+   * @param cache Cache that outlives the analyzer, or nullptr for none
+   */
+  void setSubtreeCache(SectionSubtreeCache *cache) { subtreeCache = cache; }
+
 private:
   /**
-   * Split source into lines and calculate indent levels
+   * One line of the merged source, as a view into the line it came from
    */
   struct SourceLine {
-    std::string text;     // Original text with whitespace trimmed
-    int indentLevel;      // Number of leading spaces/tabs (normalized)
-    int lineNumber;       // 1-based line number (in merged file)
-    std::string filePath; // Original file path (if available)
-    int originalLine;     // Original line number (if available)
-    int startColumn;      // Start column
-    int endColumn;        // End column
-    bool isEmpty;         // Is this line empty or comment-only?
+    std::string_view text; // Code without indent, comment or trailing space
+    int indentLevel;       // Number of leading spaces/tabs (normalized)
+    int lineNumber;        // 1-based line number (in merged file)
+    uint32_t fileSymbol;   // Interned original file path (0 if unknown)
+    int originalLine;      // Original line number (if available)
+    int startColumn;       // Start column
+    int endColumn;         // End column
+    bool isEmpty;          // Is this line empty or comment-only?
   };
 
+  /**
+   * Scan lines [begin, end) of the merged source in one pass. Nothing is
+   * copied; the text of a line is copied once, into its CodeLine.
+   */
   std::vector<SourceLine>
-  splitLines(const std::string &source,
-             const std::map<int, SourceLocation> &sourceMap);
+  splitLines(const std::vector<std::string_view> &source,
+             const std::vector<SourceMapEntry> &sourceMap, size_t begin,
+             size_t end);
 
   /**
    * Calculate indent level from leading whitespace
    * Tabs are treated as equivalent to 4 spaces
    */
-  int calculateIndent(const std::string &line, int &startCol);
+  static int calculateIndent(std::string_view line, int &startCol);
 
   /**
-   * Trim leading and trailing whitespace
+   * Strip leading whitespace, a comment and trailing whitespace
    */
-  std::string trim(const std::string &str);
-
-  /**
-   * Check if a line is a comment (starts with #)
-   */
-  bool isComment(const std::string &line);
+  static std::string_view trim(std::string_view str);
 
   /**
    * Check if a line is a pattern definition
    * Returns true if line starts with "section ", "effect ", or "expression "
    */
-  bool isPatternDefinition(const std::string &line);
+  static bool isPatternDefinition(std::string_view line);
 
   /**
-   * Check if a line ends with a colon (indicating child section follows)
+   * Check if trimmed line text ends with a colon (a child section follows)
    */
-  bool endsWithColon(const std::string &line);
+  static bool endsWithColon(std::string_view text);
 
   /**
    * Build section tree recursively
    */
   void buildSection(Section &section, const std::vector<SourceLine> &lines,
-                    size_t &index, int parentIndent);
+                    size_t &index, int parentIndent, SectionArena &arena);
+
+  /**
+   * Analyze every run of consecutive lines from one file separately and
+   * splice the subtrees into root
+   * @return false, leaving the arena empty, if some subtree cannot be spliced
+   */
+  bool analyzeFiles(SectionArena &arena,
+                    const std::vector<std::string_view> &source,
+                    const std::vector<SourceMapEntry> &sourceMap);
+
+  /**
+   * Analyze lines [begin, end) of the merged source into a subtree
+   * @param keepLines Copy the lines into the subtree for a cache
+   */
+  static SectionSubtree analyzeRun(const std::vector<std::string_view> &source,
+                                   const std::vector<SourceMapEntry> &sourceMap,
+                                   size_t begin, size_t end, bool keepLines);
 
   std::vector<Diagnostic> diagnosticsData;
+  int jobCount = 1;
+  SectionSubtreeCache *subtreeCache = nullptr;
 };
 
 } // namespace tbx
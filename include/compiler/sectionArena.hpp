@@ -0,0 +1,65 @@
+#pragma once
+
+#include "compiler/section.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace tbx {
+
+/**
+ * SectionArena - Storage for the section tree of one compilation
+ *
+ * Sections are allocated in fixed-size blocks and never move, so
+ * CodeLine::childSection and Section::parent are plain pointers into the
+ * arena. Sections must be created in pre-order: a section before the sections
+ * of its lines, and those in line order, which is the order SectionAnalyzer
+ * reaches them in. Section::index is then the position of a section in that
+ * order and sections() can be walked linearly instead of recursing through
+ * the tree. Destroying the arena frees the whole tree at once.
+ */
+class SectionArena {
+public:
+  /**
+   * Create an arena holding only an empty root section
+   */
+  SectionArena();
+
+  SectionArena(SectionArena &&other) noexcept = default;
+  SectionArena &operator=(SectionArena &&other) noexcept = default;
+  SectionArena(const SectionArena &) = delete;
+  SectionArena &operator=(const SectionArena &) = delete;
+
+  /**
+   * The root section, containing the entire program
+   */
+  Section *root() const { return sectionList.front(); }
+
+  /**
+   * Create an empty section after all existing ones in pre-order
+   */
+  Section *create();
+
+  /**
+   * Take over the sections of another arena, except its root, and append
+   * them in pre-order. Move the lines of other.root() into a section of this
+   * arena first; the other root is kept alive but not listed.
+   */
+  void adopt(SectionArena &&other);
+
+  /**
+   * All sections in pre-order; sections()[section->index] == section
+   */
+  const std::vector<Section *> &sections() const { return sectionList; }
+
+private:
+  static constexpr size_t blockSize = 64;
+
+  std::vector<std::unique_ptr<Section[]>> blocks;
+  size_t usedInBlock = 0; // Sections handed out from blocks.back()
+  std::vector<Section *> sectionList;
+};
+
+} // namespace tbx
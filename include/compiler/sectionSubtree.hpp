@@ -0,0 +1,25 @@
+#pragma once
+
+#include "compiler/sectionArena.hpp"
+
+#include <string>
+#include <vector>
+
+namespace tbx {
+
+/**
+ * SectionSubtree - The section tree of one run of lines from one file
+ *
+ * SectionAnalyzer builds one per run of consecutive lines of a file in the
+ * merged source and splices its top-level lines into the root section. A
+ * subtree can only be spliced when it starts at indent 0 and had no
+ * indentation errors; otherwise the result could differ from analyzing the
+ * merged source as a whole.
+ */
+struct SectionSubtree {
+  std::vector<std::string> lines;   // Source lines, kept to detect changes
+  SectionArena sections;            // Root holds the top-level lines
+  bool spliceable = false;          // Same result as merged analysis
+};
+
+} // namespace tbx
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "compiler/sectionSubtree.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace tbx {
+
+/**
+ * SectionSubtreeCache - Section subtrees of file runs kept across analyses
+ *
+ * Keyed by the file and the line a run starts at. A subtree is only returned
+ * while the run still has exactly the same lines, so editing one file only
+ * re-analyzes the runs of that file. Long-lived callers like the language
+ * server keep one cache for all their analyses; it holds the runs of the
+ * last analysis only.
+ */
+class SectionSubtreeCache {
+public:
+  /**
+   * Find the subtree of lines [begin, end) of a merged source
+   * @return nullptr if there is none or the lines changed
+   */
+  const SectionSubtree *find(uint32_t fileSymbol, uint32_t firstLine,
+                             const std::vector<std::string_view> &source,
+                             size_t begin, size_t end) const;
+
+  /**
+   * Remember the subtree of a run, replacing an older one
+   */
+  void store(uint32_t fileSymbol, uint32_t firstLine, SectionSubtree subtree);
+
+  /**
+   * Drop every subtree but those of the given runs, so runs an edit moved and
+   * files of closed documents or removed imports do not stay cached
+   * @param runs The (file, first line) pairs to keep
+   */
+  void retain(const std::set<std::pair<uint32_t, uint32_t>> &runs);
+
+private:
+  std::map<std::pair<uint32_t, uint32_t>, SectionSubtree> subtrees;
+};
+
+} // namespace tbx
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace tbx {
+
+/**
+ * SourceMapEntry - Where a line of the merged program came from
+ *
+ * ImportResolver keeps one entry per merged line, at index line - 1. The file
+ * is its path interned in SymbolTable::global(); lines the resolver writes
+ * itself, like the import markers, have fileSymbol 0.
+ */
+struct SourceMapEntry {
+  uint32_t fileSymbol = 0; // Interned file path, 0 if generated
+  uint32_t lineNumber = 0; // 1-based line in that file
+};
+
+} // namespace tbx
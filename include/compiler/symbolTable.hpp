@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace tbx {
+
+/**
+ * SymbolTable - Interned strings with stable integer IDs
+ *
+ * Each distinct string is stored once and identified by a dense ID, so words,
+ * variable names and file paths can be compared and hashed as integers. IDs
+ * and the strings behind them stay valid for the lifetime of the table. ID 0
+ * is always the empty string. Interning is thread-safe.
+ */
+class SymbolTable {
+public:
+  SymbolTable();
+
+  /**
+   * The table shared by the whole compiler, so IDs from different stages can
+   * be compared with each other
+   */
+  static SymbolTable &global();
+
+  /**
+   * Get the ID of a string, adding it if it is new
+   */
+  uint32_t intern(std::string_view text);
+
+  /**
+   * Get the string behind an ID
+   */
+  const std::string &name(uint32_t symbol) const;
+
+  /**
+   * Intern every whitespace-separated word of a string, in order
+   */
+  std::vector<uint32_t> internWords(std::string_view text);
+
+private:
+  // Deque elements never move, so the views used as map keys stay valid
+  std::deque<std::string> names;
+  std::unordered_map<std::string_view, uint32_t> symbols;
+  mutable std::mutex mutex;
+};
+
+} // namespace tbx
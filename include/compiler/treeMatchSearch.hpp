@@ -0,0 +1,31 @@
+#pragma once
+
+#include "compiler/treePatternMatch.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace tbx {
+
+/**
+ * TreeMatchSearch - State of one PatternTree search
+ *
+ * Tracks the best match found so far for branch-and-bound: subtrees whose
+ * specificity bound cannot beat it are skipped, and so are subtrees holding
+ * none of the candidate patterns of the line. All mutable matching state
+ * lives here rather than in the tree, so one tree can be searched from
+ * several threads at once.
+ */
+struct TreeMatchSearch {
+  std::optional<TreePatternMatch> best; // Best complete match so far
+  int bestSpecificity = 0;              // Specificity of best->pattern
+  size_t nodesVisited = 0;              // Nodes entered by this search
+
+  // Bit per insertion rank of the patterns the line may match, or nullptr
+  // to consider every pattern
+  const std::vector<uint64_t> *candidatePatterns = nullptr;
+};
+
+} // namespace tbx
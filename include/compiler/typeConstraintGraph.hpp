@@ -0,0 +1,80 @@
+#pragma once
+
+#include "compiler/inferredType.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace tbx {
+
+/**
+ * TypeConstraintGraph - Union-find over the type variables of a program
+ *
+ * Each node is a value slot, e.g. a pattern parameter. unite() records that
+ * two slots always hold the same value; require() records a type a slot
+ * must have (from the intrinsics that use it) and observe() a type of a value
+ * passed into it. solve() merges the constraints of every class in near-linear
+ * time and solution() reads the type of a class:
+ * - a required type wins, unless a value of another type is passed in
+ * - without one, the observed type, if every value passed in has that type
+ * - Unknown on any conflict
+ */
+class TypeConstraintGraph {
+public:
+  /**
+   * Add a node with no constraints
+   * @return Its index
+   */
+  size_t addNode();
+
+  /**
+   * Put two nodes in the same class
+   */
+  void unite(size_t first, size_t second);
+
+  /**
+   * Record a type the node must have
+   */
+  void require(size_t node, InferredType type);
+
+  /**
+   * Record the type of a value flowing into the node; Unknown stands for a
+   * value of unknown type
+   */
+  void observe(size_t node, InferredType type);
+
+  /**
+   * Merge the constraints of each class; call before solution()
+   */
+  void solve();
+
+  /**
+   * The type of the node's class, Unknown if there is none or it conflicts
+   */
+  InferredType solution(size_t node);
+
+private:
+  size_t find(size_t node);
+
+  /**
+   * The type two constraints agree on: the wider numeric type for i64 and
+   * f64, Unknown when they conflict
+   */
+  static InferredType join(InferredType first, InferredType second);
+
+  std::vector<size_t> parents;
+  std::vector<uint32_t> ranks;
+  std::vector<std::pair<size_t, InferredType>> requirements;
+  std::vector<std::pair<size_t, InferredType>> observations;
+
+  // Per class root, filled by solve()
+  std::vector<InferredType> requiredTypes;
+  std::vector<InferredType> observedTypes;
+  std::vector<char> requiredConflicts;
+  std::vector<char> observedConflicts;
+  std::vector<char> unknownValues; // A value of unknown type was observed
+};
+
+} // namespace tbx
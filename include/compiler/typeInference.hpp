@@ -19,7 +19,7 @@ namespace tbx {
  * TypeInference - Step 4 of the 3BX compiler pipeline
  *
  * Infers types for pattern parameters and return values based on intrinsic
- * usage.
+ * usage, then propagates parameter types across call sites.
  */
 class TypeInference {
 public:
@@ -60,8 +60,17 @@ private:
   std::unique_ptr<TypedPattern> inferPatternTypes(ResolvedPattern *pattern);
   std::unique_ptr<TypedCall> inferCallTypes(PatternMatch *match);
 
-  std::vector<IntrinsicInfo> parseIntrinsics(const std::string &text);
-  IntrinsicInfo parseSingleIntrinsic(const std::string &text, size_t startPos);
+  /**
+   * Fill in the parameter types pattern bodies leave Unknown from the values
+   * every call passes, following parameters passed on from one pattern to
+   * the next (see TypeConstraintGraph)
+   */
+  void solveCallConstraints(const SectionPatternResolver &resolver);
+
+  /**
+   * @intrinsic(...) calls of a line, from the literal spans cached on it
+   */
+  std::vector<IntrinsicInfo> parseIntrinsics(const CodeLine &line);
 
   InferredType inferValueType(const ResolvedValue &value);
   TypedValue resolvedToTyped(const ResolvedValue &value,
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "compiler/diagnostic.hpp"
+#include "compiler/sectionSubtreeCache.hpp"
 #include "lsp/lspDiagnostic.hpp"
 #include "lsp/lspLocation.hpp"
 #include "lsp/lspPosition.hpp"
@@ -52,6 +53,10 @@ private:
   std::unordered_map<std::string, std::vector<PatternDefLocation>>
       patternDefinitions;
 
+  // Section subtrees of the last analyzed document and the libraries it
+  // imports, so an edit only re-analyzes the edited file
+  SectionSubtreeCache sectionSubtrees;
+
   // Message handling
   json handleRequest(const std::string &method, const json &params,
                      const json &id);
@@ -67,6 +72,7 @@ private:
   void handleDidOpen(const json &params);
   void handleDidChange(const json &params);
   void handleDidClose(const json &params);
+  void handleDidChangeWatchedFiles(const json &params);
 
   // Language features
   json handleCompletion(const json &params);
@@ -1,4 +1,5 @@
 #include "compiler/codeGenerator.hpp"
+#include "compiler/symbolTable.hpp"
 
 #include <llvm/IR/Verifier.h>
 #include <llvm/Support/FileSystem.h>
@@ -133,6 +134,8 @@ bool SectionCodeGenerator::generate(const TypeInference &typeInferenceResult,
       for (const auto &var : typedPattern->pattern->variables) {
         codegen->parameterNames.push_back(var);
       }
+      codegen->patternWords =
+          SymbolTable::global().internWords(typedPattern->pattern->pattern);
 
       patternToCodegen[typedPattern->pattern] = codegen.get();
     }
@@ -266,41 +269,15 @@ SectionCodeGenerator::generateCodeLine(CodeLine *line,
     return generateIntrinsic(text, {});
   }
 
-  // Parse the line into words (used by pattern matching and fallback)
-  // Handle quoted strings as single tokens
-  std::vector<std::string> lineWords;
-  {
-    size_t pos = 0;
-    while (pos < text.size()) {
-      // Skip whitespace
-      while (pos < text.size() && std::isspace(text[pos])) {
-        pos++;
-      }
-      if (pos >= text.size())
-        break;
-
-      std::string token;
-      if (text[pos] == '"' || text[pos] == '\'') {
-        // Quoted string - capture until closing quote
-        char quote = text[pos];
-        token += text[pos++];
-        while (pos < text.size() && text[pos] != quote) {
-          token += text[pos++];
-        }
-        if (pos < text.size()) {
-          token += text[pos++]; // Include closing quote
-        }
-      } else {
-        // Regular word - capture until whitespace
-        while (pos < text.size() && !std::isspace(text[pos])) {
-          token += text[pos++];
-        }
-      }
-      if (!token.empty()) {
-        lineWords.push_back(token);
-      }
-    }
+  // Words of the line (used by the fallback matching below). The section
+  // analyzer already split the line; quoted strings are single words.
+  std::vector<LineWord> retrimmedWords;
+  if (text.size() != line->text.size()) {
+    retrimmedWords = splitLineWords(text);
   }
+  const std::vector<LineWord> &lineWords =
+      text.size() == line->text.size() ? line->words : retrimmedWords;
+  const uint32_t slotSymbol = SymbolTable::global().intern("$");
 
   // Check if the resolver already matched this line to a pattern
   PatternMatch *match = resolver.getPatternMatch(line);
@@ -416,13 +393,7 @@ SectionCodeGenerator::generateCodeLine(CodeLine *line,
       }
     }
 
-    // Parse pattern into words
-    std::vector<std::string> patternWords;
-    std::string word;
-    std::istringstream pss(pattern->pattern);
-    while (pss >> word) {
-      patternWords.push_back(word);
-    }
+    const std::vector<uint32_t> &patternWords = codegenPattern->patternWords;
 
     // Quick check: same number of words
     if (lineWords.size() != patternWords.size())
@@ -433,9 +404,9 @@ SectionCodeGenerator::generateCodeLine(CodeLine *line,
     std::vector<llvm::Value *> args;
 
     for (size_t wordIndex = 0; wordIndex < patternWords.size(); wordIndex++) {
-      if (patternWords[wordIndex] == "$") {
+      if (patternWords[wordIndex] == slotSymbol) {
         // Variable slot - extract argument
-        const std::string &argStr = lineWords[wordIndex];
+        std::string argStr(lineWords[wordIndex].view(text));
 
         // Use generateExpression to properly handle literals, variables, etc.
         llvm::Value *argVal = generateExpression(argStr, {});
@@ -448,7 +419,7 @@ SectionCodeGenerator::generateCodeLine(CodeLine *line,
         }
       } else {
         // Literal word - must match exactly
-        if (patternWords[wordIndex] != lineWords[wordIndex]) {
+        if (patternWords[wordIndex] != lineWords[wordIndex].symbol) {
           matches = false;
           break;
         }
@@ -507,13 +478,7 @@ SectionCodeGenerator::generateCodeLine(CodeLine *line,
       continue;
 
     ResolvedPattern *pattern = typed->pattern;
-
-    std::vector<std::string> patternWords;
-    std::istringstream pss(pattern->pattern);
-    std::string word;
-    while (pss >> word) {
-      patternWords.push_back(word);
-    }
+    const std::vector<uint32_t> &patternWords = codegenPattern->patternWords;
 
     if (lineWords.size() != patternWords.size())
       continue;
@@ -523,9 +488,9 @@ SectionCodeGenerator::generateCodeLine(CodeLine *line,
 
     for (size_t wordIndex = 0; wordIndex < patternWords.size() && matches;
          wordIndex++) {
-      if (patternWords[wordIndex] == "$") {
-        argStrings.push_back(lineWords[wordIndex]);
-      } else if (patternWords[wordIndex] != lineWords[wordIndex]) {
+      if (patternWords[wordIndex] == slotSymbol) {
+        argStrings.emplace_back(lineWords[wordIndex].view(text));
+      } else if (patternWords[wordIndex] != lineWords[wordIndex].symbol) {
         matches = false;
       }
     }
@@ -588,6 +553,9 @@ llvm::Value *SectionCodeGenerator::generateBodyLine(const std::string &text) {
   if (trimmed.empty())
     return nullptr;
 
+  SymbolTable &symbols = SymbolTable::global();
+  const uint32_t slotSymbol = symbols.intern("$");
+
   if (trimmed.find("@intrinsic(") != std::string::npos) {
     std::string check = trimmed;
     if (check.substr(0, 7) == "return ") {
@@ -631,12 +599,7 @@ llvm::Value *SectionCodeGenerator::generateBodyLine(const std::string &text) {
       continue;
     }
 
-    std::vector<std::string> patternWords;
-    std::istringstream pss(pattern->pattern);
-    std::string word;
-    while (pss >> word) {
-      patternWords.push_back(word);
-    }
+    const std::vector<uint32_t> &patternWords = codegenPattern->patternWords;
 
     std::vector<std::string> extractedArgs;
     bool matches = true;
@@ -649,11 +612,11 @@ llvm::Value *SectionCodeGenerator::generateBodyLine(const std::string &text) {
         textPos++;
       }
 
-      if (patternWords[patternWordIndex] == "$") {
+      if (patternWords[patternWordIndex] == slotSymbol) {
         std::string nextLiteral;
         if (patternWordIndex + 1 < patternWords.size() &&
-            patternWords[patternWordIndex + 1] != "$") {
-          nextLiteral = patternWords[patternWordIndex + 1];
+            patternWords[patternWordIndex + 1] != slotSymbol) {
+          nextLiteral = symbols.name(patternWords[patternWordIndex + 1]);
         }
 
         std::string arg;
@@ -669,7 +632,7 @@ llvm::Value *SectionCodeGenerator::generateBodyLine(const std::string &text) {
           extractedArgs.push_back(arg);
         }
       } else {
-        std::string literal = patternWords[patternWordIndex];
+        std::string_view literal = symbols.name(patternWords[patternWordIndex]);
         if (trimmed.compare(textPos, literal.size(), literal) == 0) {
           size_t endPos = textPos + literal.size();
           if (endPos == trimmed.size() || std::isspace(trimmed[endPos])) {
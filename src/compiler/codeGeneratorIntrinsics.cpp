@@ -203,7 +203,7 @@ llvm::Value *SectionCodeGenerator::generateIntrinsic(
               // Return an opaque pointer or index to the section
               return llvm::ConstantInt::get(
                   llvm::Type::getInt64Ty(*context),
-                  (uint64_t)frame.callSite->childSection.get());
+                  (uint64_t)frame.callSite->childSection);
             }
           } else if (count >= 0) {
             // Current section (0) or parent sections (1+)
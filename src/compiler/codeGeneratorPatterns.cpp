@@ -110,7 +110,7 @@ void SectionCodeGenerator::generatePatternFunctionBody(
     // Check for known section types
     if (lineText == "execute" || lineText == "get" || lineText == "check") {
       if (line.childSection) {
-        bodySection = line.childSection.get();
+        bodySection = line.childSection;
         break;
       }
     }
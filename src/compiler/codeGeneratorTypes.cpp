@@ -1,4 +1,5 @@
 #include "compiler/codeGenerator.hpp"
+#include "compiler/symbolTable.hpp"
 
 #include <algorithm>
 #include <cctype>
@@ -50,6 +51,8 @@ void SectionCodeGenerator::runTypeInference(SectionPatternResolver &resolver) {
       for (const auto &var : typedPattern->pattern->variables) {
         codegen->parameterNames.push_back(var);
       }
+      codegen->patternWords =
+          SymbolTable::global().internWords(typedPattern->pattern->pattern);
 
       patternToCodegen[typedPattern->pattern] = codegen.get();
     }
@@ -0,0 +1,64 @@
+#include "compiler/importPathCache.hpp"
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace tbx {
+
+// The file name an import searches for, e.g. "lib/loop" -> "loop.3bx"
+static std::string importFileName(const std::string &importPath) {
+  std::string normalizedImport = importPath;
+  if (normalizedImport.find(".3bx") == std::string::npos) {
+    normalizedImport += ".3bx";
+  }
+  return fs::path(normalizedImport).filename().string();
+}
+
+// ============================================================================
+// ImportPathCache Implementation
+// ============================================================================
+
+ImportPathCache &ImportPathCache::global() {
+  static ImportPathCache cache;
+  return cache;
+}
+
+bool ImportPathCache::find(const std::string &importPath,
+                           const std::string &sourceDir,
+                           std::string &resolvedPath) const {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto entry = entries.find({importPath, sourceDir});
+  if (entry == entries.end()) {
+    return false;
+  }
+  resolvedPath = entry->second;
+  return true;
+}
+
+void ImportPathCache::store(const std::string &importPath,
+                            const std::string &sourceDir,
+                            const std::string &resolvedPath) {
+  std::lock_guard<std::mutex> lock(mutex);
+  entries[{importPath, sourceDir}] = resolvedPath;
+}
+
+void ImportPathCache::invalidate(const std::string &path) {
+  std::string fileName = fs::path(path).filename().string();
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto entry = entries.begin(); entry != entries.end();) {
+    if (entry->second == path ||
+        importFileName(entry->first.first) == fileName) {
+      entry = entries.erase(entry);
+    } else {
+      ++entry;
+    }
+  }
+}
+
+void ImportPathCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+  entries.clear();
+}
+
+} // namespace tbx
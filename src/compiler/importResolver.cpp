@@ -1,39 +1,58 @@
 #include "compiler/importResolver.hpp"
+#include "compiler/importPathCache.hpp"
+#include "compiler/symbolTable.hpp"
 
 #include <algorithm>
-#include <fstream>
-#include <iostream>
-#include <sstream>
+#include <atomic>
+#include <functional>
+#include <thread>
 
 namespace fs = std::filesystem;
 
 namespace tbx {
 
-ImportResolver::ImportResolver(const std::string &baseDirParam)
-    : baseDir(baseDirParam) {
-  // Normalize base directory
-  if (!baseDir.empty() && fs::exists(baseDir)) {
-    baseDir = fs::canonical(baseDir).string();
+// Run task(0) .. task(count - 1) on up to jobCount threads. Each worker
+// claims the next index, so the slow network reads do not serialize.
+static void forEachParallel(size_t count, int jobCount,
+                            const std::function<void(size_t)> &task) {
+  size_t threadCount = std::min<size_t>(jobCount, count);
+  std::atomic<size_t> nextIndex{0};
+  auto worker = [&]() {
+    for (size_t index = nextIndex++; index < count; index = nextIndex++) {
+      task(index);
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t threadIndex = 1; threadIndex < threadCount; threadIndex++) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : workers) {
+    thread.join();
   }
 }
 
-std::string ImportResolver::readFile(const std::string &path) {
-  std::ifstream file(path);
-  if (!file) {
-    diagnosticsData.emplace_back("Cannot open file: " + path, path);
-    return "";
+// Split text into lines like std::getline: a final line without '\n' counts,
+// a trailing '\n' does not start another line
+static std::vector<std::string_view> splitLines(std::string_view text) {
+  std::vector<std::string_view> lines;
+  size_t lineStart = 0;
+  while (lineStart < text.size()) {
+    size_t lineEnd = text.find('\n', lineStart);
+    if (lineEnd == std::string_view::npos) {
+      lineEnd = text.size();
+    }
+    lines.push_back(text.substr(lineStart, lineEnd - lineStart));
+    lineStart = lineEnd + 1;
   }
-  std::stringstream buffer;
-  buffer << file.rdbuf();
-  return buffer.str();
+  return lines;
 }
 
-std::string ImportResolver::resolveImportPath(const std::string &importPath,
-                                              const std::string &sourceFile) {
-  fs::path sourceDir = fs::path(sourceFile).parent_path();
-  if (sourceDir.empty())
-    sourceDir = ".";
-
+// Tries 1-3 of import resolution: everything that depends on the directory
+// of the importing file
+static std::string searchSourceTree(const std::string &importPath,
+                                    const fs::path &sourceDir) {
   // Normalize the import path - add .3bx extension if missing
   std::string normalizedImport = importPath;
   if (normalizedImport.find(".3bx") == std::string::npos) {
@@ -81,21 +100,165 @@ std::string ImportResolver::resolveImportPath(const std::string &importPath,
     searchDir = parent;
   }
 
+  return "";
+}
+
+ImportResolver::ImportResolver(const std::string &baseDirParam)
+    : baseDir(baseDirParam) {
+  // Normalize base directory
+  if (!baseDir.empty() && fs::exists(baseDir)) {
+    baseDir = fs::canonical(baseDir).string();
+  }
+}
+
+void ImportResolver::reset() {
+  mergedLinesData.clear();
+  sourceMapData.clear();
+  resolvedFilesData.clear();
+  diagnosticsData.clear();
+  mappedFiles.clear();
+  ownedTexts.clear();
+}
+
+std::string_view ImportResolver::mapFile(const std::string &path) {
+  MappedFile &file = mappedFiles.emplace_back();
+  if (!file.open(path)) {
+    mappedFiles.pop_back();
+    diagnosticsData.emplace_back("Cannot open file: " + path, path);
+    return {};
+  }
+  return file.text();
+}
+
+std::string_view ImportResolver::ownText(std::string text) {
+  return ownedTexts.emplace_back(std::move(text));
+}
+
+void ImportResolver::appendLine(std::string_view text, uint32_t fileSymbol,
+                                uint32_t lineNumber) {
+  mergedLinesData.push_back(text);
+  sourceMapData.push_back({fileSymbol, lineNumber});
+}
+
+std::string ImportResolver::resolveImportPath(const std::string &importPath,
+                                              const std::string &sourceFile) {
+  std::string resolvedPath;
+  auto preloaded = preloadedPaths.find({sourceFile, importPath});
+  if (preloaded != preloadedPaths.end()) {
+    resolvedPath = preloaded->second;
+  } else {
+    resolvedPath = findImportPath(importPath, sourceFile);
+  }
+  if (!resolvedPath.empty()) {
+    return resolvedPath;
+  }
+
+  // Return original path - will fail later with proper error
+  diagnosticsData.emplace_back("Cannot resolve import: " + importPath,
+                               sourceFile);
+  return importPath;
+}
+
+std::string ImportResolver::findInSourceTree(const std::string &importPath,
+                                             const std::string &sourceDir) {
+  ImportPathCache &cache = ImportPathCache::global();
+  std::string resolvedPath;
+  if (!cache.find(importPath, sourceDir, resolvedPath)) {
+    resolvedPath = searchSourceTree(importPath, sourceDir);
+    cache.store(importPath, sourceDir, resolvedPath);
+  }
+  return resolvedPath;
+}
+
+std::string
+ImportResolver::findImportPath(const std::string &importPath,
+                               const std::string &sourceFile) const {
+  fs::path sourceDir = fs::path(sourceFile).parent_path();
+  if (sourceDir.empty())
+    sourceDir = ".";
+
+  std::string resolvedPath = findInSourceTree(importPath, sourceDir.string());
+  if (!resolvedPath.empty()) {
+    return resolvedPath;
+  }
+
   // Try 4: Search from base directory
   if (!baseDir.empty()) {
+    std::string normalizedImport = importPath;
+    if (normalizedImport.find(".3bx") == std::string::npos) {
+      normalizedImport += ".3bx";
+    }
     fs::path libPath = fs::path(baseDir) / "lib" / normalizedImport;
     if (fs::exists(libPath)) {
       return fs::canonical(libPath).string();
     }
   }
+  return "";
+}
 
-  // Return original path - will fail later with proper error
-  diagnosticsData.emplace_back("Cannot resolve import: " + importPath,
-                               sourceFile);
-  return importPath;
+void ImportResolver::preloadImports(
+    const std::vector<std::pair<std::string, std::string_view>> &roots) {
+  preloadedFiles.clear();
+  preloadedPaths.clear();
+  if (jobCount <= 1) {
+    return;
+  }
+
+  std::set<std::string> discovered;
+  for (const auto &[path, source] : roots) {
+    discovered.insert(path);
+  }
+
+  // Breadth-first over the import graph. Only the shared maps are filled
+  // serially, in file and line order, so the result is deterministic.
+  std::vector<std::pair<std::string, std::string_view>> level = roots;
+  while (!level.empty()) {
+    std::vector<std::vector<std::pair<std::string, std::string>>> imports(
+        level.size());
+    forEachParallel(level.size(), jobCount, [&](size_t fileIndex) {
+      const auto &[path, source] = level[fileIndex];
+      for (std::string_view line : splitLines(source)) {
+        std::string importPath = extractImportPath(line);
+        if (!importPath.empty()) {
+          imports[fileIndex].emplace_back(importPath,
+                                          findImportPath(importPath, path));
+        }
+      }
+    });
+
+    std::vector<std::string> nextPaths;
+    for (size_t fileIndex = 0; fileIndex < level.size(); fileIndex++) {
+      for (const auto &[importPath, resolvedPath] : imports[fileIndex]) {
+        preloadedPaths[{level[fileIndex].first, importPath}] = resolvedPath;
+        if (!resolvedPath.empty() && discovered.insert(resolvedPath).second) {
+          nextPaths.push_back(resolvedPath);
+        }
+      }
+    }
+
+    // Unreadable files are left to processSource(), which reports them
+    size_t firstFile = mappedFiles.size();
+    for (size_t fileIndex = 0; fileIndex < nextPaths.size(); fileIndex++) {
+      mappedFiles.emplace_back();
+    }
+    std::vector<char> loaded(nextPaths.size(), 0);
+    forEachParallel(nextPaths.size(), jobCount, [&](size_t fileIndex) {
+      loaded[fileIndex] =
+          mappedFiles[firstFile + fileIndex].open(nextPaths[fileIndex]);
+    });
+
+    level.clear();
+    for (size_t fileIndex = 0; fileIndex < nextPaths.size(); fileIndex++) {
+      if (loaded[fileIndex]) {
+        std::string_view text = mappedFiles[firstFile + fileIndex].text();
+        preloadedFiles[nextPaths[fileIndex]] = text;
+        level.emplace_back(nextPaths[fileIndex], text);
+      }
+    }
+  }
 }
 
-std::string ImportResolver::extractImportPath(const std::string &line) {
+std::string ImportResolver::extractImportPath(std::string_view line) {
   // Trim leading whitespace
   size_t start = 0;
   while (start < line.size() && (line[start] == ' ' || line[start] == '\t')) {
@@ -103,10 +266,10 @@ std::string ImportResolver::extractImportPath(const std::string &line) {
   }
 
   // Check if line starts with "import " (simple text matching, not a keyword)
-  const std::string importPrefix = "import ";
+  const std::string_view importPrefix = "import ";
   if (line.size() >= start + importPrefix.size() &&
       line.substr(start, importPrefix.size()) == importPrefix) {
-    std::string path = line.substr(start + importPrefix.size());
+    std::string_view path = line.substr(start + importPrefix.size());
 
     // Trim trailing whitespace
     size_t end = path.size();
@@ -114,18 +277,20 @@ std::string ImportResolver::extractImportPath(const std::string &line) {
                        path[end - 1] == '\r' || path[end - 1] == '\n')) {
       end--;
     }
-    return path.substr(0, end);
+    return std::string(path.substr(0, end));
   }
 
   return "";
 }
 
-std::string ImportResolver::processSource(const std::string &source,
-                                          const std::string &sourcePath,
-                                          std::set<std::string> &visited) {
+void ImportResolver::processSource(std::string_view source,
+                                   const std::string &sourcePath,
+                                   std::set<std::string> &visited) {
   // Get canonical path to avoid circular imports
   std::string canonicalPath;
-  if (fs::exists(sourcePath)) {
+  if (preloadedFiles.count(sourcePath)) {
+    canonicalPath = sourcePath;
+  } else if (fs::exists(sourcePath)) {
     canonicalPath = fs::canonical(sourcePath).string();
   } else {
     canonicalPath = sourcePath;
@@ -133,17 +298,15 @@ std::string ImportResolver::processSource(const std::string &source,
 
   // Check for circular import
   if (visited.count(canonicalPath)) {
-    return ""; // Already processed, skip
+    return; // Already processed, skip
   }
   visited.insert(canonicalPath);
   resolvedFilesData.push_back(canonicalPath);
 
-  std::stringstream result;
-  std::istringstream stream(source);
-  std::string line;
-  int currentLineNumber = 0;
+  uint32_t fileSymbol = SymbolTable::global().intern(sourcePath);
+  uint32_t currentLineNumber = 0;
 
-  while (std::getline(stream, line)) {
+  for (std::string_view line : splitLines(source)) {
     currentLineNumber++;
 
     // Check if this is an import line
@@ -152,115 +315,97 @@ std::string ImportResolver::processSource(const std::string &source,
     if (!importPath.empty()) {
       // Resolve the import path
       std::string resolvedPath = resolveImportPath(importPath, sourcePath);
+      auto preloaded = preloadedFiles.find(resolvedPath);
 
-      if (fs::exists(resolvedPath)) {
+      if (preloaded != preloadedFiles.end() || fs::exists(resolvedPath)) {
         // Read and process the imported file
-        std::string importedSource = readFile(resolvedPath);
+        std::string_view importedSource = preloaded != preloadedFiles.end()
+                                              ? preloaded->second
+                                              : mapFile(resolvedPath);
         if (!importedSource.empty()) {
           // Add a comment marker for debugging
-          std::string beginMsg = "# Begin import: " + importPath + "\n";
-          result << beginMsg;
-          currentMergedLine++; // Comment line
-
-          result << processSource(importedSource, resolvedPath, visited);
-
-          std::string endMsg = "# End import: " + importPath + "\n";
-          result << endMsg;
-          currentMergedLine++; // Comment line
+          appendLine(ownText("# Begin import: " + importPath));
+          processSource(importedSource, resolvedPath, visited);
+          appendLine(ownText("# End import: " + importPath));
         }
       } else {
         // Keep the import line as a comment with error
-        std::string errMsg =
-            "# ERROR: Cannot find import: " + importPath + "\n";
-        result << errMsg;
-        currentMergedLine++;
+        appendLine(ownText("# ERROR: Cannot find import: " + importPath));
       }
     } else {
       // Not an import line, keep as-is
-      result << line << "\n";
-      currentMergedLine++;
-
-      // Record source mapping
-      sourceMapData[currentMergedLine] = {sourcePath, currentLineNumber};
+      appendLine(line, fileSymbol, currentLineNumber);
     }
   }
-
-  return result.str();
 }
 
-std::string ImportResolver::resolve(const std::string &filePath) {
-  // Reset state
-  sourceMapData.clear();
-  currentMergedLine = 0;
-  resolvedFilesData.clear();
-  diagnosticsData.clear();
+const std::vector<std::string_view> &
+ImportResolver::resolve(const std::string &filePath) {
+  reset();
 
   // Read the source file
-  std::string source = readFile(filePath);
+  std::string_view source = mapFile(filePath);
   if (source.empty() && !diagnosticsData.empty()) {
-    return "";
+    return mergedLinesData;
   }
-
-  return resolveSource(source, filePath);
+  return merge(source, filePath, false);
 }
 
-std::string
+const std::vector<std::string_view> &
 ImportResolver::resolveWithPrelude(const std::string &filePath,
                                    const std::string &overrideContent) {
-  // Reset state
-  sourceMapData.clear();
-  currentMergedLine = 0;
-  resolvedFilesData.clear();
-  diagnosticsData.clear();
+  reset();
 
   // Read the source file or use override
-  std::string source = overrideContent;
-  if (source.empty()) {
-    source = readFile(filePath);
-  }
-
+  std::string_view source = overrideContent.empty()
+                                ? mapFile(filePath)
+                                : ownText(overrideContent);
   if (source.empty() && !diagnosticsData.empty()) {
-    return "";
+    return mergedLinesData;
   }
+  return merge(source, filePath, true);
+}
 
-  // Auto-prepend prelude import if not already present
-  if (source.find("import lib/prelude") == std::string::npos &&
-      source.find("import prelude") == std::string::npos) {
-    // Manually handle the prelude injection in the merged output and source map
-    // We can't just modify 'source' because we need to track lines
-
-    std::string resolvedPath = resolveImportPath("lib/prelude.3bx", filePath);
-
-    std::stringstream result;
-
-    if (fs::exists(resolvedPath)) {
-      std::string importedSource = readFile(resolvedPath);
-      if (!importedSource.empty()) {
-        result << "# Begin import: lib/prelude\n";
-        currentMergedLine++;
-
-        std::set<std::string>
-            visited; // Local visited set for prelude to avoid recursion issues
-        result << processSource(importedSource, resolvedPath, visited);
-
-        result << "# End import: lib/prelude\n";
-        currentMergedLine++;
-      }
-    }
+const std::vector<std::string_view> &
+ImportResolver::resolveSource(const std::string &source,
+                              const std::string &sourcePath) {
+  reset();
+  return merge(ownText(source), sourcePath, false);
+}
 
-    // Now process the main file
+const std::vector<std::string_view> &
+ImportResolver::merge(std::string_view source, const std::string &sourcePath,
+                      bool withPrelude) {
+  // Auto-prepend prelude import if not already present
+  if (!withPrelude || source.find("import lib/prelude") != std::string::npos ||
+      source.find("import prelude") != std::string::npos) {
+    preloadImports({{sourcePath, source}});
     std::set<std::string> visited;
-    result << processSource(source, filePath, visited);
-    return result.str();
+    processSource(source, sourcePath, visited);
+    return mergedLinesData;
   }
 
-  return resolveSource(source, filePath);
-}
+  // Manually handle the prelude injection in the merged output and source map
+  // We can't just modify 'source' because we need to track lines
+  std::string resolvedPath = resolveImportPath("lib/prelude.3bx", sourcePath);
+  std::string_view importedSource;
+  if (fs::exists(resolvedPath)) {
+    importedSource = mapFile(resolvedPath);
+  }
+  preloadImports({{resolvedPath, importedSource}, {sourcePath, source}});
+
+  if (!importedSource.empty()) {
+    appendLine("# Begin import: lib/prelude");
+    std::set<std::string>
+        visited; // Local visited set for prelude to avoid recursion issues
+    processSource(importedSource, resolvedPath, visited);
+    appendLine("# End import: lib/prelude");
+  }
 
-std::string ImportResolver::resolveSource(const std::string &source,
-                                          const std::string &sourcePath) {
+  // Now process the main file
   std::set<std::string> visited;
-  return processSource(source, sourcePath, visited);
+  processSource(source, sourcePath, visited);
+  return mergedLinesData;
 }
 
 } // namespace tbx
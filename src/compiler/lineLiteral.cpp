@@ -0,0 +1,203 @@
+#include "compiler/lineLiteral.hpp"
+
+#include <cctype>
+
+namespace tbx {
+
+// ============================================================================
+// Line Literal Detection Implementation
+// ============================================================================
+
+static LineLiteral makeLiteral(LineLiteralType type, size_t start,
+                               size_t end) {
+  LineLiteral literal;
+  literal.type = type;
+  literal.start = static_cast<uint32_t>(start);
+  literal.length = static_cast<uint32_t>(end - start);
+  return literal;
+}
+
+static bool isDigit(char character) {
+  return std::isdigit(static_cast<unsigned char>(character)) != 0;
+}
+
+std::vector<LineLiteral> detectLineLiterals(std::string_view text) {
+  std::vector<LineLiteral> literals;
+  size_t charIndex = 0;
+
+  while (charIndex < text.size()) {
+    // Skip whitespace
+    if (std::isspace(static_cast<unsigned char>(text[charIndex]))) {
+      charIndex++;
+      continue;
+    }
+
+    // Check for intrinsic call: @name(...)
+    if (text[charIndex] == '@') {
+      std::string name;
+      std::vector<std::string> args;
+      size_t end = parseIntrinsicCall(text, charIndex, name, args);
+      if (end != std::string::npos) {
+        LineLiteral literal =
+            makeLiteral(LineLiteralType::Intrinsic, charIndex, end);
+        literal.intrinsicName = std::move(name);
+        literal.intrinsicArgs = std::move(args);
+        literals.push_back(std::move(literal));
+        charIndex = end;
+        continue;
+      }
+    }
+
+    // Check for string literal: "..." or '...'
+    if (text[charIndex] == '"' || text[charIndex] == '\'') {
+      char quote = text[charIndex];
+      size_t start = charIndex;
+      charIndex++; // Skip opening quote
+      while (charIndex < text.size() && text[charIndex] != quote) {
+        if (text[charIndex] == '\\' && charIndex + 1 < text.size()) {
+          charIndex += 2; // Skip escape sequence
+        } else {
+          charIndex++;
+        }
+      }
+      if (charIndex < text.size()) {
+        charIndex++; // Skip closing quote
+      }
+      literals.push_back(
+          makeLiteral(LineLiteralType::String, start, charIndex));
+      continue;
+    }
+
+    // Check for number literal: 123, 3.14, -7
+    if (isDigit(text[charIndex]) ||
+        (text[charIndex] == '-' && charIndex + 1 < text.size() &&
+         isDigit(text[charIndex + 1]))) {
+      size_t start = charIndex;
+      if (text[charIndex] == '-')
+        charIndex++;
+      while (charIndex < text.size() && isDigit(text[charIndex]))
+        charIndex++;
+      if (charIndex < text.size() && text[charIndex] == '.') {
+        charIndex++;
+        while (charIndex < text.size() && isDigit(text[charIndex]))
+          charIndex++;
+      }
+      literals.push_back(
+          makeLiteral(LineLiteralType::Number, start, charIndex));
+      continue;
+    }
+
+    // Check for grouping parentheses: (...)
+    if (text[charIndex] == '(') {
+      size_t start = charIndex;
+      int depth = 1;
+      charIndex++;
+      while (charIndex < text.size() && depth > 0) {
+        if (text[charIndex] == '(')
+          depth++;
+        else if (text[charIndex] == ')')
+          depth--;
+        charIndex++;
+      }
+      literals.push_back(makeLiteral(LineLiteralType::Group, start, charIndex));
+      continue;
+    }
+
+    // Skip other characters (identifiers, operators, etc.)
+    charIndex++;
+  }
+
+  return literals;
+}
+
+// Trim spaces and tabs from both ends of an argument; empty if blank
+static std::string trimArgument(const std::string &argument) {
+  size_t startIdx = argument.find_first_not_of(" \t");
+  if (startIdx == std::string::npos) {
+    return "";
+  }
+  size_t endIdx = argument.find_last_not_of(" \t");
+  return argument.substr(startIdx, endIdx - startIdx + 1);
+}
+
+size_t parseIntrinsicCall(std::string_view text, size_t startPos,
+                          std::string &name, std::vector<std::string> &args) {
+  if (startPos >= text.size() || text[startPos] != '@') {
+    return std::string::npos;
+  }
+
+  // Parse name: @name
+  size_t charIndex = startPos + 1;
+  size_t nameStart = charIndex;
+  while (charIndex < text.size() &&
+         (std::isalnum(static_cast<unsigned char>(text[charIndex])) ||
+          text[charIndex] == '_')) {
+    charIndex++;
+  }
+  if (charIndex == nameStart) {
+    return std::string::npos; // No name
+  }
+  name = std::string(text.substr(nameStart, charIndex - nameStart));
+
+  // Expect opening paren
+  if (charIndex >= text.size() || text[charIndex] != '(') {
+    return std::string::npos;
+  }
+  charIndex++; // Skip '('
+
+  // Parse arguments
+  args.clear();
+  std::string currentArg;
+  int parenDepth = 1;
+  bool inString = false;
+  char stringChar = '\0';
+
+  while (charIndex < text.size() && parenDepth > 0) {
+    char character = text[charIndex];
+
+    if (inString) {
+      currentArg += character;
+      if (character == stringChar &&
+          (currentArg.size() < 2 ||
+           currentArg[currentArg.size() - 2] != '\\')) {
+        inString = false;
+      }
+    } else if (character == '"' || character == '\'') {
+      inString = true;
+      stringChar = character;
+      currentArg += character;
+    } else if (character == '(') {
+      parenDepth++;
+      currentArg += character;
+    } else if (character == ')') {
+      parenDepth--;
+      if (parenDepth > 0) {
+        currentArg += character;
+      }
+    } else if (character == ',' && parenDepth == 1) {
+      // Argument separator
+      std::string argument = trimArgument(currentArg);
+      if (!argument.empty()) {
+        args.push_back(std::move(argument));
+      }
+      currentArg.clear();
+    } else {
+      currentArg += character;
+    }
+    charIndex++;
+  }
+
+  // Add last argument
+  std::string argument = trimArgument(currentArg);
+  if (!argument.empty()) {
+    args.push_back(std::move(argument));
+  }
+
+  if (parenDepth != 0) {
+    return std::string::npos; // Unbalanced parens
+  }
+
+  return charIndex;
+}
+
+} // namespace tbx
@@ -0,0 +1,129 @@
+#include "compiler/literalScanner.hpp"
+
+#include <algorithm>
+
+namespace tbx {
+
+// ============================================================================
+// LiteralScanner Implementation
+// ============================================================================
+
+LiteralScanner::LiteralScanner() { states.emplace_back(); }
+
+uint32_t LiteralScanner::addWord(const std::string &word) {
+  auto existing = wordIds.find(word);
+  if (existing != wordIds.end()) {
+    return existing->second;
+  }
+  uint32_t wordId = static_cast<uint32_t>(wordIds.size());
+  wordIds.emplace(word, wordId);
+
+  // Extend the trie of word prefixes
+  uint32_t stateIndex = 0;
+  for (char character : word) {
+    auto byte = static_cast<unsigned char>(character);
+    uint32_t next = findTransition(stateIndex, byte);
+    if (next == LiteralScannerState::noState) {
+      next = static_cast<uint32_t>(states.size());
+      states.emplace_back();
+      auto &transitions = states[stateIndex].transitions;
+      auto position = std::lower_bound(
+          transitions.begin(), transitions.end(), byte,
+          [](const std::pair<unsigned char, uint32_t> &transition,
+             unsigned char key) { return transition.first < key; });
+      transitions.insert(position, {byte, next});
+    }
+    stateIndex = next;
+  }
+  states[stateIndex].word = wordId;
+  return wordId;
+}
+
+void LiteralScanner::build() {
+  // Breadth-first, so a state's failure target is linked before the state
+  std::vector<uint32_t> queue;
+  for (const auto &transition : states[0].transitions) {
+    states[transition.second].failure = 0;
+    states[transition.second].outputLink = LiteralScannerState::noState;
+    queue.push_back(transition.second);
+  }
+
+  for (size_t queueIndex = 0; queueIndex < queue.size(); queueIndex++) {
+    uint32_t parent = queue[queueIndex];
+    for (const auto &transition : states[parent].transitions) {
+      uint32_t child = transition.second;
+
+      // Longest proper suffix of child's prefix that is a prefix too
+      uint32_t fallback = states[parent].failure;
+      uint32_t target = findTransition(fallback, transition.first);
+      while (target == LiteralScannerState::noState && fallback != 0) {
+        fallback = states[fallback].failure;
+        target = findTransition(fallback, transition.first);
+      }
+      if (target == LiteralScannerState::noState) {
+        target = 0;
+      }
+
+      states[child].failure = target;
+      states[child].outputLink = states[target].word !=
+                                         LiteralScannerState::noState
+                                     ? target
+                                     : states[target].outputLink;
+      queue.push_back(child);
+    }
+  }
+}
+
+std::vector<uint32_t> LiteralScanner::scan(std::string_view text) const {
+  std::vector<uint32_t> found;
+  if (wordIds.empty()) {
+    return found;
+  }
+
+  std::vector<bool> seen(wordIds.size(), false);
+  uint32_t stateIndex = 0;
+  for (char character : text) {
+    auto byte = static_cast<unsigned char>(character);
+    uint32_t next = findTransition(stateIndex, byte);
+    while (next == LiteralScannerState::noState && stateIndex != 0) {
+      stateIndex = states[stateIndex].failure;
+      next = findTransition(stateIndex, byte);
+    }
+    stateIndex = next == LiteralScannerState::noState ? 0 : next;
+
+    // Report the word ending here and every shorter word it ends with
+    uint32_t output = states[stateIndex].word != LiteralScannerState::noState
+                          ? stateIndex
+                          : states[stateIndex].outputLink;
+    while (output != LiteralScannerState::noState) {
+      uint32_t wordId = states[output].word;
+      if (!seen[wordId]) {
+        seen[wordId] = true;
+        found.push_back(wordId);
+      }
+      output = states[output].outputLink;
+    }
+  }
+  return found;
+}
+
+void LiteralScanner::clear() {
+  states.clear();
+  states.emplace_back();
+  wordIds.clear();
+}
+
+uint32_t LiteralScanner::findTransition(uint32_t stateIndex,
+                                        unsigned char byte) const {
+  const auto &transitions = states[stateIndex].transitions;
+  auto position = std::lower_bound(
+      transitions.begin(), transitions.end(), byte,
+      [](const std::pair<unsigned char, uint32_t> &transition,
+         unsigned char key) { return transition.first < key; });
+  if (position != transitions.end() && position->first == byte) {
+    return position->second;
+  }
+  return LiteralScannerState::noState;
+}
+
+} // namespace tbx
@@ -0,0 +1,51 @@
+#include "compiler/mappedFile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tbx {
+
+// ============================================================================
+// MappedFile Implementation
+// ============================================================================
+
+MappedFile::~MappedFile() { close(); }
+
+bool MappedFile::open(const std::string &path) {
+  close();
+  int descriptor = ::open(path.c_str(), O_RDONLY);
+  if (descriptor < 0) {
+    return false;
+  }
+  struct stat status;
+  if (::fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode)) {
+    ::close(descriptor);
+    return false;
+  }
+  if (status.st_size == 0) {
+    ::close(descriptor);
+    return true;
+  }
+
+  size_t length = static_cast<size_t>(status.st_size);
+  void *mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+  ::close(descriptor);
+  if (mapped == MAP_FAILED) {
+    return false;
+  }
+  data = static_cast<const char *>(mapped);
+  size = length;
+  return true;
+}
+
+void MappedFile::close() {
+  if (data) {
+    ::munmap(const_cast<char *>(data), size);
+  }
+  data = nullptr;
+  size = 0;
+}
+
+} // namespace tbx
@@ -0,0 +1,102 @@
+#include "compiler/operatorPrecedenceTable.hpp"
+
+namespace tbx {
+
+// ============================================================================
+// OperatorPrecedenceTable Implementation
+// ============================================================================
+
+void OperatorPrecedenceTable::addOperator(InfixOperator infixOperator) {
+  if (infixOperator.spelling.size() < 3)
+    return;
+
+  auto secondByte = static_cast<unsigned char>(infixOperator.spelling[1]);
+  operatorsBySecondByte[secondByte].push_back(
+      static_cast<uint32_t>(operators.size()));
+  operators.push_back(std::move(infixOperator));
+}
+
+void OperatorPrecedenceTable::clear() {
+  operators.clear();
+  for (auto &bucket : operatorsBySecondByte) {
+    bucket.clear();
+  }
+}
+
+std::string OperatorPrecedenceTable::infixSpelling(const std::string &variant) {
+  // Shape: "$ <op> $" where <op> is plain text
+  if (variant.size() < 5 || variant.compare(0, 2, "$ ") != 0 ||
+      variant.compare(variant.size() - 2, 2, " $") != 0) {
+    return "";
+  }
+
+  std::string spelling = variant.substr(1, variant.size() - 2);
+  if (spelling.find_first_of("${}") != std::string::npos ||
+      spelling.find_first_not_of(' ') == std::string::npos) {
+    return "";
+  }
+  return spelling;
+}
+
+const InfixOperator *
+OperatorPrecedenceTable::findSplit(const std::string &input, size_t startPos,
+                                   size_t &operatorPos) const {
+  const InfixOperator *best = nullptr;
+  int depth = 0;
+  char quote = 0;
+
+  for (size_t pos = startPos; pos < input.size(); pos++) {
+    char character = input[pos];
+
+    // Skip over quoted strings and bracketed groups
+    if (quote) {
+      if (character == quote)
+        quote = 0;
+      continue;
+    }
+    bool atTokenStart = pos == startPos || input[pos - 1] == ' ' ||
+                        input[pos - 1] == '(' || input[pos - 1] == '[';
+    if ((character == '"' || character == '\'') && atTokenStart) {
+      quote = character;
+      continue;
+    }
+    if (character == '(' || character == '[') {
+      depth++;
+      continue;
+    }
+    if (character == ')' || character == ']') {
+      if (depth > 0)
+        depth--;
+      continue;
+    }
+    if (depth > 0 || character != ' ' || pos == startPos ||
+        pos + 1 >= input.size()) {
+      continue;
+    }
+
+    auto secondByte = static_cast<unsigned char>(input[pos + 1]);
+    for (uint32_t operatorIndex : operatorsBySecondByte[secondByte]) {
+      const InfixOperator &candidate = operators[operatorIndex];
+      size_t length = candidate.spelling.size();
+
+      // Both operands must be non-empty
+      if (pos + length >= input.size() ||
+          input.compare(pos, length, candidate.spelling) != 0) {
+        continue;
+      }
+
+      bool better = !best || candidate.level < best->level ||
+                    (candidate.level == best->level &&
+                     (pos > operatorPos ||
+                      (pos == operatorPos && length > best->spelling.size())));
+      if (better) {
+        best = &candidate;
+        operatorPos = pos;
+      }
+    }
+  }
+
+  return best;
+}
+
+} // namespace tbx
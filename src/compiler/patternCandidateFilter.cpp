@@ -0,0 +1,95 @@
+#include "compiler/patternCandidateFilter.hpp"
+
+#include <algorithm>
+
+namespace tbx {
+
+// ============================================================================
+// PatternCandidateFilter Implementation
+// ============================================================================
+
+void PatternCandidateFilter::addPattern(size_t slot,
+                                        const std::vector<std::string> &words) {
+  if (words.empty()) {
+    addSlot(unconditionalPatterns, slot);
+    return;
+  }
+
+  // A word repeated in the pattern only needs to occur once
+  std::vector<uint32_t> wordIds;
+  for (const std::string &word : words) {
+    wordIds.push_back(scanner.addWord(word));
+  }
+  std::sort(wordIds.begin(), wordIds.end());
+  wordIds.erase(std::unique(wordIds.begin(), wordIds.end()), wordIds.end());
+
+  uint32_t patternIndex = static_cast<uint32_t>(patternSlots.size());
+  patternSlots.push_back(slot);
+  patternWordCounts.push_back(static_cast<uint32_t>(wordIds.size()));
+  if (patternsByWord.size() < scanner.wordCount()) {
+    patternsByWord.resize(scanner.wordCount());
+  }
+  for (uint32_t wordId : wordIds) {
+    patternsByWord[wordId].push_back(patternIndex);
+  }
+}
+
+void PatternCandidateFilter::build() { scanner.build(); }
+
+std::vector<uint64_t>
+PatternCandidateFilter::candidates(std::string_view text) const {
+  std::vector<uint64_t> bits = unconditionalPatterns;
+  if (patternSlots.empty()) {
+    return bits;
+  }
+
+  // Count the words of each pattern that occur; a pattern whose count
+  // reaches its total is a candidate
+  std::vector<uint32_t> wordsFound(patternSlots.size(), 0);
+  for (uint32_t wordId : scanner.scan(text)) {
+    for (uint32_t patternIndex : patternsByWord[wordId]) {
+      if (++wordsFound[patternIndex] == patternWordCounts[patternIndex]) {
+        addSlot(bits, patternSlots[patternIndex]);
+      }
+    }
+  }
+  return bits;
+}
+
+void PatternCandidateFilter::addSlot(std::vector<uint64_t> &bits,
+                                     size_t slot) {
+  if (bits.size() <= slot / 64) {
+    bits.resize(slot / 64 + 1, 0);
+  }
+  bits[slot / 64] |= uint64_t(1) << (slot % 64);
+}
+
+void PatternCandidateFilter::mergeSlots(std::vector<uint64_t> &bits,
+                                        const std::vector<uint64_t> &other) {
+  if (bits.size() < other.size()) {
+    bits.resize(other.size(), 0);
+  }
+  for (size_t wordIndex = 0; wordIndex < other.size(); wordIndex++) {
+    bits[wordIndex] |= other[wordIndex];
+  }
+}
+
+bool PatternCandidateFilter::sharesSlot(const std::vector<uint64_t> &bits,
+                                        const std::vector<uint64_t> &other) {
+  size_t common = std::min(bits.size(), other.size());
+  for (size_t wordIndex = 0; wordIndex < common; wordIndex++) {
+    if (bits[wordIndex] & other[wordIndex])
+      return true;
+  }
+  return false;
+}
+
+void PatternCandidateFilter::clear() {
+  scanner.clear();
+  patternsByWord.clear();
+  patternSlots.clear();
+  patternWordCounts.clear();
+  unconditionalPatterns.clear();
+}
+
+} // namespace tbx
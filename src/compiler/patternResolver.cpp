@@ -1,7 +1,7 @@
 #include "compiler/patternResolver.hpp"
+#include "compiler/symbolTable.hpp"
 
 #include <algorithm>
-#include <cctype>
 #include <iostream>
 #include <sstream>
 
@@ -16,48 +16,6 @@ static std::string trim(const std::string &str) {
   return str.substr(start, end - start + 1);
 }
 
-// Helper to check if a word appears as a standalone identifier in a string
-// e.g., "val" appears in "var + val" but not in "value"
-static bool containsIdentifier(const std::string &text,
-                               const std::string &word) {
-  if (word.empty())
-    return false;
-
-  size_t pos = 0;
-  while ((pos = text.find(word, pos)) != std::string::npos) {
-    // Check if the character before is not alphanumeric/underscore (or at
-    // start)
-    bool validStart =
-        (pos == 0) || (!std::isalnum(text[pos - 1]) && text[pos - 1] != '_');
-
-    // Check if the character after is not alphanumeric/underscore (or at end)
-    size_t endPos = pos + word.size();
-    bool validEnd = (endPos >= text.size()) ||
-                    (!std::isalnum(text[endPos]) && text[endPos] != '_');
-
-    if (validStart && validEnd) {
-      return true;
-    }
-    pos++;
-  }
-  return false;
-}
-
-// Extract the identifier portion from a pattern word
-// e.g., "number%" -> "number", "var's" -> "var", "count" -> "count"
-static std::string extractIdentifierFromWord(const std::string &word) {
-  std::string result;
-  for (char character : word) {
-    if (std::isalnum(character) || character == '_') {
-      result += character;
-    } else {
-      // Stop at first non-identifier character
-      break;
-    }
-  }
-  return result;
-}
-
 PatternType patternTypeFromPrefix(const std::string &prefix) {
   if (prefix == "effect")
     return PatternType::Effect;
@@ -159,12 +117,7 @@ std::vector<std::string> expandAlternatives(const std::string &patternText) {
 
 SectionPatternResolver::SectionPatternResolver() = default;
 
-bool SectionPatternResolver::resolve(Section *root) {
-  if (!root) {
-    diagnosticsData.emplace_back("Cannot resolve null section");
-    return false;
-  }
-
+bool SectionPatternResolver::resolve(SectionArena &sections) {
   // Clear previous state
   patternDefinitionsData.clear();
   patternMatchesData.clear();
@@ -173,10 +126,14 @@ bool SectionPatternResolver::resolve(Section *root) {
   lineToPatternData.clear();
   lineToMatchData.clear();
   diagnosticsData.clear();
+  pendingTreeUpdates.clear();
+  effectTree.clear();
+  sectionTree.clear();
+  expressionTree.clear();
 
-  // Collect all code lines and sections
-  collectCodeLines(root, allLinesData);
-  collectSections(root, allSectionsData);
+  // Collect all code lines; the arena already lists the sections in pre-order
+  collectCodeLines(sections.root(), allLinesData);
+  allSectionsData = sections.sections();
 
   // Extract all pattern definitions
   for (CodeLine *line : allLinesData) {
@@ -189,6 +146,7 @@ bool SectionPatternResolver::resolve(Section *root) {
         if (lineToPatternData.find(line) == lineToPatternData.end()) {
           lineToPatternData[line] = pattern.get();
         }
+        pendingTreeUpdates.push_back(pattern.get());
         patternDefinitionsData.push_back(std::move(pattern));
       }
     }
@@ -212,6 +170,7 @@ bool SectionPatternResolver::resolve(Section *root) {
 
   // Phase 1: Resolve single-word pattern definitions
   resolveSingleWordPatterns();
+  initializeWorklists();
 
   // Iterate Phases 2, 3, and 4 until convergence
   while (true) {
@@ -233,14 +192,15 @@ bool SectionPatternResolver::resolve(Section *root) {
       progress = true;
     }
 
-    // Check if all patterns are resolved
-    bool allResolved = true;
-    for (CodeLine *line : allLinesData) {
-      if (!line->isResolved) {
-        allResolved = false;
-        break;
-      }
-    }
+    // Check if all patterns are resolved. Every line that was unresolved when
+    // the loop started is on the worklist, so only those need checking.
+    unresolvedLines.erase(std::remove_if(unresolvedLines.begin(),
+                                         unresolvedLines.end(),
+                                         [](const CodeLine *line) {
+                                           return line->isResolved;
+                                         }),
+                          unresolvedLines.end());
+    bool allResolved = unresolvedLines.empty();
     iteration++;
     if (iteration == maxIterations || !progress) {
       diagnosticsData.emplace_back("Cannot resolve all patterns");
@@ -252,10 +212,13 @@ bool SectionPatternResolver::resolve(Section *root) {
     }
   }
 
+  // Operator precedence is fixed once all pattern strings are final
+  buildOperatorTable();
+
   // Check for unresolved patterns
   for (CodeLine *line : allLinesData) {
     if (!line->isResolved) {
-      std::string filePath = line->filePath;
+      const std::string &filePath = line->filePath();
       int lineNum = line->lineNumber;
 
       diagnosticsData.emplace_back("Unresolved pattern: " + line->text,
@@ -275,20 +238,7 @@ void SectionPatternResolver::collectCodeLines(Section *section,
   for (auto &line : section->lines) {
     lines.push_back(&line);
     if (line.childSection) {
-      collectCodeLines(line.childSection.get(), lines);
-    }
-  }
-}
-
-void SectionPatternResolver::collectSections(Section *section,
-                                             std::vector<Section *> &sections) {
-  if (!section)
-    return;
-
-  sections.push_back(section);
-  for (auto &line : section->lines) {
-    if (line.childSection) {
-      collectSections(line.childSection.get(), sections);
+      collectCodeLines(line.childSection, lines);
     }
   }
 }
@@ -351,43 +301,33 @@ void SectionPatternResolver::resolveSingleWordPatterns() {
 bool SectionPatternResolver::resolvePatternReferences() {
   bool progress = false;
 
-  // Rebuild pattern trees with currently resolved patterns
-  buildPatternTrees();
+  // Bring pattern trees up to date with patterns changed since last iteration.
+  // A line that failed to match before can only match one of those now.
+  std::vector<CodeLine *> pendingLines =
+      linesToRetry(updatePatternTrees());
 
-  for (CodeLine *line : allLinesData) {
-    // Skip already resolved lines
-    if (line->isResolved) {
-      continue;
-    }
+  // Match against the trees (possibly in parallel), then record the results
+  // in line order so the outcome does not depend on thread scheduling
+  auto treeMatches = findTreeMatches(pendingLines);
 
-    // Skip pattern definitions (they resolve differently)
-    if (line->isPatternDefinition) {
+  for (size_t lineIndex = 0; lineIndex < pendingLines.size(); lineIndex++) {
+    CodeLine *line = pendingLines[lineIndex];
+    if (!treeMatches[lineIndex]) {
       continue;
     }
-
-    // Try to match this reference using tree-based matching
-    PatternMatch *match = matchWithTree(line);
+    PatternMatch *match = commitTreeMatch(line, *treeMatches[lineIndex]);
 
     if (match) {
       line->isResolved = true;
       progress = true;
+      markLineMatched(line);
 
       // Add arguments to the parent section's resolved variables
-      Section *parent = nullptr;
-      for (Section *section : allSectionsData) {
-        for (auto &secLine : section->lines) {
-          if (&secLine == line) {
-            parent = section;
-            break;
-          }
-        }
-        if (parent)
-          break;
-      }
-
+      Section *parent = line->parentSection;
       if (parent) {
         for (const auto &[name, info] : match->arguments) {
-          parent->resolvedVariables[name] = info.value;
+          parent->resolvedVariables[SymbolTable::global().intern(name)] =
+              info.value;
         }
       }
     }
@@ -399,7 +339,13 @@ bool SectionPatternResolver::resolvePatternReferences() {
 bool SectionPatternResolver::resolveSections() {
   bool progress = false;
 
-  for (Section *section : allSectionsData) {
+  // Only sections that gained a resolved line can have become resolved.
+  // Sections marked while walking the set are visited in this same pass when
+  // they come later in order, just like a full sweep would.
+  for (auto sectionIt = dirtySections.begin(); sectionIt != dirtySections.end();
+       sectionIt = dirtySections.erase(sectionIt)) {
+    Section *section = allSectionsData[*sectionIt];
+
     // Skip already resolved sections
     if (section->isResolved) {
       continue;
@@ -412,9 +358,16 @@ bool SectionPatternResolver::resolveSections() {
 
       // Find any pattern definition that has this section as its body
       // and mark it as resolved
-      for (auto &pattern : patternDefinitionsData) {
-        if (pattern->body == section && !pattern->sourceLine->isResolved) {
+      auto bodyPatterns = patternsByBody.find(section);
+      if (bodyPatterns == patternsByBody.end()) {
+        continue;
+      }
+      for (size_t patternIndex : bodyPatterns->second) {
+        ResolvedPattern *pattern = patternDefinitionsData[patternIndex].get();
+        if (!pattern->sourceLine->isResolved) {
           pattern->sourceLine->isResolved = true;
+          pendingTreeUpdates.push_back(pattern);
+          markLineResolved(pattern->sourceLine);
         }
       }
     }
@@ -426,137 +379,85 @@ bool SectionPatternResolver::resolveSections() {
 bool SectionPatternResolver::propagateVariablesFromCalls() {
   bool progress = false;
 
-  // For each pattern definition, look at its body's resolved pattern calls
-  for (auto &pattern : patternDefinitionsData) {
-    if (!pattern->body)
-      continue;
+  // Only patterns whose body gained a match can gain variables
+  for (size_t patternIndex : dirtyPatterns) {
+    if (propagateVariablesToPattern(patternIndex)) {
+      progress = true;
+    }
+  }
+  dirtyPatterns.clear();
 
-    // Get the original words from this pattern's text
-    std::vector<std::string> originalWords =
-        parsePatternWords(pattern->originalText);
+  return progress;
+}
 
-    // Collect new variables found from pattern calls
-    std::vector<std::string> newVariables;
+bool SectionPatternResolver::propagateVariablesToPattern(size_t patternIndex) {
+  ResolvedPattern *pattern = patternDefinitionsData[patternIndex].get();
+  PatternVariableIndex &index = variableIndices[patternIndex];
 
-    // Check each line in the body
-    for (const auto &line : pattern->body->lines) {
-      // Skip section headers like "execute:", "get:"
-      std::string lineText = line.text;
-      size_t start = lineText.find_first_not_of(" \t");
-      if (start == std::string::npos)
-        continue;
-      lineText = lineText.substr(start);
-
-      // Skip if this is a section header
-      if (!lineText.empty() && lineText.back() == ':') {
-        std::string header = lineText.substr(0, lineText.size() - 1);
-        if (header == "execute" || header == "get" || header == "check" ||
-            header == "patterns" || header == "priority") {
-          // Recurse into child section
-          if (line.childSection) {
-            for (const auto &childLine : line.childSection->lines) {
-              // Find if this line has a pattern match
-              auto it =
-                  lineToMatchData.find(const_cast<CodeLine *>(&childLine));
-              if (it != lineToMatchData.end()) {
-                PatternMatch *match = it->second;
-                // Check each argument
-                for (const auto &[varName, info] : match->arguments) {
-                  // If the value is a string, check if it's one of our pattern
-                  // words
-                  if (std::holds_alternative<std::string>(info.value)) {
-                    const std::string &argStr =
-                        std::get<std::string>(info.value);
-                    // Check if any pattern word's identifier appears in this
-                    // argument
-                    for (const auto &word : originalWords) {
-                      std::string identifier = extractIdentifierFromWord(word);
-                      if (identifier.empty())
-                        continue;
-                      if (containsIdentifier(argStr, identifier)) {
-                        // This identifier is used as an argument to a pattern
-                        // call So it should be a variable
-                        bool alreadyVar = false;
-                        for (const auto &v : pattern->variables) {
-                          if (v == identifier) {
-                            alreadyVar = true;
-                            break;
-                          }
-                        }
-                        if (!alreadyVar) {
-                          bool alreadyNew = false;
-                          for (const auto &v : newVariables) {
-                            if (v == identifier) {
-                              alreadyNew = true;
-                              break;
-                            }
-                          }
-                          if (!alreadyNew) {
-                            newVariables.push_back(identifier);
-                          }
-                        }
-                      }
-                    }
-                  }
-                }
-              }
-            }
-          }
-          continue;
+  // Look at the body's resolved pattern calls
+  if (!pattern->body)
+    return false;
+
+  // Collect new variables found from pattern calls
+  std::vector<std::string> newVariables;
+
+  // A pattern word whose identifier is passed as an argument to a pattern
+  // call should be a variable
+  auto collectFromLine = [&](const CodeLine *line) {
+    auto it = lineToMatchData.find(const_cast<CodeLine *>(line));
+    if (it == lineToMatchData.end())
+      return;
+    for (const auto &identifiers : argumentIdentifiers(it->second)) {
+      for (const auto &identifier : index.wordIdentifiers) {
+        if (!identifier.empty() && identifiers.count(identifier) &&
+            index.variables.insert(identifier).second) {
+          newVariables.push_back(identifier);
         }
       }
-
-      // Direct line (not inside a subsection)
-      auto it = lineToMatchData.find(const_cast<CodeLine *>(&line));
-      if (it != lineToMatchData.end()) {
-        PatternMatch *match = it->second;
-        for (const auto &[varName, info] : match->arguments) {
-          if (std::holds_alternative<std::string>(info.value)) {
-            const std::string &argStr = std::get<std::string>(info.value);
-            // Check if any pattern word's identifier appears in this argument
-            for (const auto &word : originalWords) {
-              std::string identifier = extractIdentifierFromWord(word);
-              if (identifier.empty())
-                continue;
-              if (containsIdentifier(argStr, identifier)) {
-                bool alreadyVar = false;
-                for (const auto &v : pattern->variables) {
-                  if (v == identifier) {
-                    alreadyVar = true;
-                    break;
-                  }
-                }
-                if (!alreadyVar) {
-                  bool alreadyNew = false;
-                  for (const auto &v : newVariables) {
-                    if (v == identifier) {
-                      alreadyNew = true;
-                      break;
-                    }
-                  }
-                  if (!alreadyNew) {
-                    newVariables.push_back(identifier);
-                  }
-                }
-              }
-            }
+    }
+  };
+
+  // Check each line in the body
+  for (const auto &line : pattern->body->lines) {
+    // Skip section headers like "execute:", "get:"
+    std::string lineText = line.text;
+    size_t start = lineText.find_first_not_of(" \t");
+    if (start == std::string::npos)
+      continue;
+    lineText = lineText.substr(start);
+
+    // Skip if this is a section header
+    if (!lineText.empty() && lineText.back() == ':') {
+      std::string header = lineText.substr(0, lineText.size() - 1);
+      if (header == "execute" || header == "get" || header == "check" ||
+          header == "patterns" || header == "priority") {
+        // Recurse into child section
+        if (line.childSection) {
+          for (const auto &childLine : line.childSection->lines) {
+            collectFromLine(&childLine);
           }
         }
+        continue;
       }
     }
 
-    // If we found new variables, update the pattern
-    if (!newVariables.empty()) {
-      for (const auto &var : newVariables) {
-        pattern->variables.push_back(var);
-      }
-      // Rebuild the pattern string with the new variables
-      pattern->pattern = createPatternString(originalWords, pattern->variables);
-      progress = true;
+    // Direct line (not inside a subsection)
+    collectFromLine(&line);
+  }
+
+  // If we found new variables, update the pattern
+  if (!newVariables.empty()) {
+    for (const auto &var : newVariables) {
+      pattern->variables.push_back(var);
     }
+    // Rebuild the pattern string with the new variables
+    pattern->pattern =
+        createPatternString(index.originalWords, pattern->variables);
+    pendingTreeUpdates.push_back(pattern);
+    return true;
   }
 
-  return progress;
+  return false;
 }
 
 void SectionPatternResolver::printResults() const {
@@ -28,7 +28,7 @@ SectionPatternResolver::extractPatternDefinitions(CodeLine *line) {
   }
 
   // Check for "patterns:" subsection
-  Section *body = line->childSection.get();
+  Section *body = line->childSection;
   if (body) {
     for (const auto &bodyLine : body->lines) {
       std::string text = bodyLine.text;
@@ -42,7 +42,7 @@ SectionPatternResolver::extractPatternDefinitions(CodeLine *line) {
             // Create a temporary pattern definition
             auto pattern = std::make_unique<ResolvedPattern>();
             pattern->sourceLine = const_cast<CodeLine *>(&altLine);
-            pattern->body = line->childSection.get();
+            pattern->body = line->childSection;
             pattern->isPrivate = line->isPrivate;
             pattern->type = line->type;
             pattern->originalText = altLine.text;
@@ -100,7 +100,7 @@ SectionPatternResolver::extractPatternDefinition(CodeLine *line) {
 
   auto pattern = std::make_unique<ResolvedPattern>();
   pattern->sourceLine = line;
-  pattern->body = line->childSection.get();
+  pattern->body = line->childSection;
   pattern->isPrivate = line->isPrivate;
   pattern->type = line->type;
 
@@ -315,7 +315,7 @@ static void collectIntrinsicArgsFromSection(Section *section,
 
     // Recurse into child sections
     if (line.childSection) {
-      collectIntrinsicArgsFromSection(line.childSection.get(), allArgs);
+      collectIntrinsicArgsFromSection(line.childSection, allArgs);
     }
   }
 }
@@ -585,35 +585,25 @@ bool SectionPatternResolver::isSingleWordWithSection(
 }
 
 bool SectionPatternResolver::isInsidePatternsSection(CodeLine *line) const {
-  if (!line)
+  if (!line || !line->parentSection)
     return false;
 
-  // Find the parent section of this line
-  for (Section *section : allSectionsData) {
-    for (const auto &secLine : section->lines) {
-      if (&secLine == line) {
-        // Found the parent section, now check if this section's parent line is
-        // "patterns:"
-        if (section->parent) {
-          // Find the parent line that owns this section
-          for (auto &parentLine : section->parent->lines) {
-            if (parentLine.childSection.get() == section) {
-              // Check if the parent line is "patterns:"
-              std::string parentText = parentLine.getPatternText();
-              // Trim whitespace
-              size_t start = parentText.find_first_not_of(" \t");
-              if (start != std::string::npos) {
-                parentText = parentText.substr(start);
-              }
-              return parentText == "patterns";
-            }
-          }
-        }
-        return false;
-      }
-    }
+  // Check whether the line owning this line's section is "patterns:"
+  const Section *section = line->parentSection;
+  if (!section->parent ||
+      section->parentLineIndex >= section->parent->lines.size())
+    return false;
+  const CodeLine &parentLine = section->parent->lines[section->parentLineIndex];
+  if (parentLine.childSection != section)
+    return false;
+
+  std::string parentText = parentLine.getPatternText();
+  // Trim whitespace
+  size_t start = parentText.find_first_not_of(" \t");
+  if (start != std::string::npos) {
+    parentText = parentText.substr(start);
   }
-  return false;
+  return parentText == "patterns";
 }
 
 } // namespace tbx
@@ -0,0 +1,162 @@
+#include "compiler/patternResolver.hpp"
+
+#include <climits>
+#include <map>
+#include <set>
+
+namespace tbx {
+
+// Helper to trim whitespace
+static std::string trimPriority(const std::string &str) {
+  size_t start = str.find_first_not_of(" \t\n\r");
+  if (start == std::string::npos)
+    return "";
+  size_t end = str.find_last_not_of(" \t\n\r");
+  return str.substr(start, end - start + 1);
+}
+
+// Level of a pattern whose own level is still being computed
+static const int levelInProgress = INT_MIN;
+
+// The priority: directive lines of a pattern body, in order
+static std::vector<const CodeLine *> priorityLines(const Section *body) {
+  std::vector<const CodeLine *> lines;
+  if (!body) {
+    return lines;
+  }
+  for (const auto &line : body->lines) {
+    if (trimPriority(line.text).rfind("priority", 0) == 0) {
+      lines.push_back(&line);
+    }
+  }
+  return lines;
+}
+
+// ============================================================================
+// Operator Precedence Implementation
+// ============================================================================
+
+void SectionPatternResolver::buildOperatorTable() {
+  OperatorPrecedenceTable table;
+  std::map<ResolvedPattern *, int> levels;
+  std::set<const Section *> checkedBodies;
+
+  for (auto &pattern : patternDefinitionsData) {
+    if (pattern->type != PatternType::Expression ||
+        !pattern->sourceLine->isResolved) {
+      continue;
+    }
+
+    // Only the first directive counts; patterns sharing a body report the
+    // others once
+    if (checkedBodies.insert(pattern->body).second) {
+      std::vector<const CodeLine *> directives = priorityLines(pattern->body);
+      for (size_t index = 1; index < directives.size(); index++) {
+        reportPriorityError("More than one priority: directive for pattern "
+                            "\"" + pattern->pattern + "\"",
+                            directives[index]);
+      }
+    }
+
+    // Every alternative spelling must be a plain binary pattern
+    std::vector<std::string> spellings;
+    for (const auto &variant : expandAlternatives(pattern->pattern)) {
+      std::string spelling = OperatorPrecedenceTable::infixSpelling(variant);
+      if (spelling.empty()) {
+        spellings.clear();
+        break;
+      }
+      spellings.push_back(spelling);
+    }
+
+    int level = priorityLevel(pattern.get(), levels);
+    for (auto &spelling : spellings) {
+      table.addOperator(
+          InfixOperator{std::move(spelling), pattern.get(), level});
+    }
+  }
+
+  expressionTree.setOperatorTable(std::move(table));
+}
+
+int SectionPatternResolver::priorityLevel(
+    ResolvedPattern *pattern, std::map<ResolvedPattern *, int> &levels) {
+  auto known = levels.find(pattern);
+  if (known != levels.end() && known->second != levelInProgress) {
+    return known->second;
+  }
+  if (known != levels.end()) {
+    // The directives lead back to this pattern; it stays at level 0
+    std::vector<const CodeLine *> directives = priorityLines(pattern->body);
+    reportPriorityError("Cycle in priority: directives through pattern \"" +
+                            pattern->pattern + "\"",
+                        directives.empty() ? pattern->sourceLine
+                                           : directives.front());
+    levels[pattern] = 0;
+    return 0;
+  }
+  levels[pattern] = levelInProgress;
+
+  bool bindsTighter = false;
+  std::string target;
+  int level = 0;
+  if (parsePriorityDirective(pattern, bindsTighter, target)) {
+    if (ResolvedPattern *targetPattern = findPriorityTarget(target)) {
+      int targetLevel = priorityLevel(targetPattern, levels);
+      level = bindsTighter ? targetLevel + 1 : targetLevel - 1;
+    }
+  }
+
+  levels[pattern] = level;
+  return level;
+}
+
+void SectionPatternResolver::reportPriorityError(const std::string &message,
+                                                 const CodeLine *line) {
+  diagnosticsData.emplace_back(message, line->filePath(), line->lineNumber,
+                               line->startColumn, line->lineNumber,
+                               line->endColumn);
+}
+
+bool SectionPatternResolver::parsePriorityDirective(
+    const ResolvedPattern *pattern, bool &bindsTighter,
+    std::string &target) const {
+  std::vector<const CodeLine *> directives = priorityLines(pattern->body);
+  if (!directives.empty()) {
+    // "priority: before $ + $" or "priority after $ + $"
+    std::string text = trimPriority(directives.front()->text);
+    text = text.substr(8);
+    if (!text.empty() && text[0] == ':') {
+      text = text.substr(1);
+    }
+    text = trimPriority(text);
+
+    for (const char *keyword : {"before ", "after "}) {
+      std::string prefix = keyword;
+      if (text.rfind(prefix, 0) == 0) {
+        bindsTighter = prefix == "before ";
+        target = trimPriority(text.substr(prefix.size()));
+        return !target.empty();
+      }
+    }
+  }
+  return false;
+}
+
+ResolvedPattern *
+SectionPatternResolver::findPriorityTarget(const std::string &target) const {
+  // Targets are written either as pattern strings ("$ + $") or like the
+  // definition itself ("left + right")
+  for (const auto &pattern : patternDefinitionsData) {
+    if (pattern->type != PatternType::Expression) {
+      continue;
+    }
+    if (pattern->pattern == target ||
+        trimPriority(pattern->originalText) == target) {
+      return pattern.get();
+    }
+  }
+  return nullptr;
+}
+
+} // namespace tbx
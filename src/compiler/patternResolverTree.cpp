@@ -1,9 +1,10 @@
 #include "compiler/patternResolver.hpp"
 
 #include <algorithm>
-#include <cctype>
+#include <atomic>
 #include <iostream>
 #include <sstream>
+#include <thread>
 
 namespace tbx {
 
@@ -17,33 +18,63 @@ void SectionPatternResolver::buildPatternTrees() {
   sectionTree.clear();
   expressionTree.clear();
 
-  // Add all resolved patterns to the appropriate trees
+  // Queue every pattern; the update adds the resolved ones
+  pendingTreeUpdates.clear();
   for (auto &pattern : patternDefinitionsData) {
-    if (!pattern || !pattern->sourceLine->isResolved) {
+    if (pattern) {
+      pendingTreeUpdates.push_back(pattern.get());
+    }
+  }
+  updatePatternTrees();
+}
+
+std::vector<ResolvedPattern *> SectionPatternResolver::updatePatternTrees() {
+  // Add or refresh queued patterns that are resolved. Unresolved ones stay
+  // queued until they resolve.
+  std::vector<ResolvedPattern *> stillPending;
+  std::vector<ResolvedPattern *> changedPatterns;
+  for (ResolvedPattern *pattern : pendingTreeUpdates) {
+    if (!pattern->sourceLine->isResolved) {
+      stillPending.push_back(pattern);
       continue;
     }
 
     // Skip private patterns - they'll be handled specially during matching
     // by checking file visibility
 
+    bool changed = false;
     switch (pattern->type) {
     case PatternType::Effect:
-      effectTree.addPattern(pattern.get());
+      changed = effectTree.updatePattern(pattern);
       break;
     case PatternType::Section:
-      sectionTree.addPattern(pattern.get());
+      changed = sectionTree.updatePattern(pattern);
       break;
     case PatternType::Expression:
-      expressionTree.addPattern(pattern.get());
+      changed = expressionTree.updatePattern(pattern);
       break;
     }
+    if (changed) {
+      changedPatterns.push_back(pattern);
+    }
   }
+  pendingTreeUpdates = std::move(stillPending);
+  return changedPatterns;
 }
 
 PatternMatch *SectionPatternResolver::matchWithTree(CodeLine *line) {
-  if (!line || line->isPatternDefinition) {
+  auto treeMatch = findTreeMatch(line);
+  if (!treeMatch) {
     return nullptr;
   }
+  return commitTreeMatch(line, *treeMatch);
+}
+
+std::optional<TreePatternMatch>
+SectionPatternResolver::findTreeMatch(const CodeLine *line) {
+  if (!line || line->isPatternDefinition) {
+    return std::nullopt;
+  }
 
   std::string referenceText = line->getPatternText();
 
@@ -70,11 +101,16 @@ PatternMatch *SectionPatternResolver::matchWithTree(CodeLine *line) {
   }
 
   if (!treeMatch || !treeMatch->pattern) {
-    return nullptr;
+    return std::nullopt;
   }
+  return treeMatch;
+}
 
+PatternMatch *
+SectionPatternResolver::commitTreeMatch(CodeLine *line,
+                                        const TreePatternMatch &treeMatch) {
   // Convert tree match to pattern match
-  auto match = treeMatchToPatternMatch(*treeMatch, treeMatch->pattern);
+  auto match = treeMatchToPatternMatch(treeMatch, treeMatch.pattern);
   if (!match) {
     return nullptr;
   }
@@ -84,194 +120,37 @@ PatternMatch *SectionPatternResolver::matchWithTree(CodeLine *line) {
   return patternMatchesData.back().get();
 }
 
-std::vector<SectionPatternResolver::ParsedLiteral>
-SectionPatternResolver::detectLiterals(const std::string &input) {
-  std::vector<ParsedLiteral> literals;
-  size_t charIndex = 0;
+std::vector<std::optional<TreePatternMatch>>
+SectionPatternResolver::findTreeMatches(const std::vector<CodeLine *> &lines) {
+  std::vector<std::optional<TreePatternMatch>> results(lines.size());
 
-  while (charIndex < input.size()) {
-    // Skip whitespace
-    if (std::isspace(input[charIndex])) {
-      charIndex++;
-      continue;
-    }
-
-    // Check for intrinsic call: @name(...)
-    if (input[charIndex] == '@') {
-      std::string name;
-      std::vector<std::string> args;
-      size_t end = parseIntrinsicCall(input, charIndex, name, args);
-      if (end != std::string::npos) {
-        ParsedLiteral lit;
-        lit.type = ParsedLiteral::Type::Intrinsic;
-        lit.text = input.substr(charIndex, end - charIndex);
-        lit.startPos = charIndex;
-        lit.endPos = end;
-        lit.intrinsicArgs = std::move(args);
-        literals.push_back(std::move(lit));
-        charIndex = end;
-        continue;
-      }
-    }
-
-    // Check for string literal: "..." or '...'
-    if (input[charIndex] == '"' || input[charIndex] == '\'') {
-      char quote = input[charIndex];
-      size_t start = charIndex;
-      charIndex++; // Skip opening quote
-      while (charIndex < input.size() && input[charIndex] != quote) {
-        if (input[charIndex] == '\\' && charIndex + 1 < input.size()) {
-          charIndex += 2; // Skip escape sequence
-        } else {
-          charIndex++;
-        }
-      }
-      if (charIndex < input.size()) {
-        charIndex++; // Skip closing quote
-      }
-      ParsedLiteral lit;
-      lit.type = ParsedLiteral::Type::String;
-      lit.text = input.substr(start, charIndex - start);
-      lit.startPos = start;
-      lit.endPos = charIndex;
-      literals.push_back(std::move(lit));
-      continue;
+  size_t threadCount = std::min<size_t>(jobCount, lines.size());
+  if (threadCount <= 1) {
+    for (size_t lineIndex = 0; lineIndex < lines.size(); lineIndex++) {
+      results[lineIndex] = findTreeMatch(lines[lineIndex]);
     }
-
-    // Check for number literal: 123, 3.14, -7
-    if (std::isdigit(input[charIndex]) ||
-        (input[charIndex] == '-' && charIndex + 1 < input.size() &&
-         std::isdigit(input[charIndex + 1]))) {
-      size_t start = charIndex;
-      if (input[charIndex] == '-')
-        charIndex++;
-      while (charIndex < input.size() && std::isdigit(input[charIndex]))
-        charIndex++;
-      if (charIndex < input.size() && input[charIndex] == '.') {
-        charIndex++;
-        while (charIndex < input.size() && std::isdigit(input[charIndex]))
-          charIndex++;
-      }
-      ParsedLiteral lit;
-      lit.type = ParsedLiteral::Type::Number;
-      lit.text = input.substr(start, charIndex - start);
-      lit.startPos = start;
-      lit.endPos = charIndex;
-      literals.push_back(std::move(lit));
-      continue;
-    }
-
-    // Check for grouping parentheses: (...)
-    if (input[charIndex] == '(') {
-      size_t start = charIndex;
-      int depth = 1;
-      charIndex++;
-      while (charIndex < input.size() && depth > 0) {
-        if (input[charIndex] == '(')
-          depth++;
-        else if (input[charIndex] == ')')
-          depth--;
-        charIndex++;
-      }
-      ParsedLiteral lit;
-      lit.type = ParsedLiteral::Type::Group;
-      lit.text = input.substr(start, charIndex - start);
-      lit.startPos = start;
-      lit.endPos = charIndex;
-      literals.push_back(std::move(lit));
-      continue;
-    }
-
-    // Skip other characters (identifiers, operators, etc.)
-    charIndex++;
+    return results;
   }
 
-  return literals;
-}
-
-size_t
-SectionPatternResolver::parseIntrinsicCall(const std::string &input,
-                                           size_t startPos, std::string &name,
-                                           std::vector<std::string> &args) {
-  if (startPos >= input.size() || input[startPos] != '@') {
-    return std::string::npos;
-  }
-
-  // Parse name: @name
-  size_t charIndex = startPos + 1;
-  size_t nameStart = charIndex;
-  while (charIndex < input.size() &&
-         (std::isalnum(input[charIndex]) || input[charIndex] == '_')) {
-    charIndex++;
-  }
-  if (charIndex == nameStart) {
-    return std::string::npos; // No name
-  }
-  name = input.substr(nameStart, charIndex - nameStart);
-
-  // Expect opening paren
-  if (charIndex >= input.size() || input[charIndex] != '(') {
-    return std::string::npos;
-  }
-  charIndex++; // Skip '('
-  // Parse arguments
-  args.clear();
-  std::string currentArg;
-  int parenDepth = 1;
-  bool inString = false;
-  char stringChar = '\0';
-
-  while (charIndex < input.size() && parenDepth > 0) {
-    char character = input[charIndex];
-
-    if (inString) {
-      currentArg += character;
-      if (character == stringChar &&
-          (currentArg.size() < 2 ||
-           currentArg[currentArg.size() - 2] != '\\')) {
-        inString = false;
-      }
-    } else if (character == '"' || character == '\'') {
-      inString = true;
-      stringChar = character;
-      currentArg += character;
-    } else if (character == '(') {
-      parenDepth++;
-      currentArg += character;
-    } else if (character == ')') {
-      parenDepth--;
-      if (parenDepth > 0) {
-        currentArg += character;
-      }
-    } else if (character == ',' && parenDepth == 1) {
-      // Argument separator
-      // Trim whitespace
-      size_t startIdx = currentArg.find_first_not_of(" \t");
-      size_t endIdx = currentArg.find_last_not_of(" \t");
-      if (startIdx != std::string::npos) {
-        args.push_back(currentArg.substr(startIdx, endIdx - startIdx + 1));
-      }
-      currentArg.clear();
-    } else {
-      currentArg += character;
+  // Each worker claims the next unmatched line, so threads that get cheap
+  // lines simply take more of them. Every result goes to its own slot.
+  std::atomic<size_t> nextLine{0};
+  auto worker = [&]() {
+    for (size_t lineIndex = nextLine++; lineIndex < lines.size();
+         lineIndex = nextLine++) {
+      results[lineIndex] = findTreeMatch(lines[lineIndex]);
     }
-    charIndex++;
-  }
+  };
 
-  // Add last argument
-  if (!currentArg.empty()) {
-    size_t startIdx = currentArg.find_first_not_of(" \t");
-    size_t endIdx = currentArg.find_last_not_of(" \t");
-    if (startIdx != std::string::npos) {
-      args.push_back(currentArg.substr(startIdx, endIdx - startIdx + 1));
-    }
+  std::vector<std::thread> workers;
+  for (size_t threadIndex = 1; threadIndex < threadCount; threadIndex++) {
+    workers.emplace_back(worker);
   }
-
-  if (parenDepth != 0) {
-    return std::string::npos; // Unbalanced parens
+  worker();
+  for (auto &thread : workers) {
+    thread.join();
   }
-
-  return charIndex;
+  return results;
 }
 
 std::unique_ptr<PatternMatch> SectionPatternResolver::treeMatchToPatternMatch(
@@ -0,0 +1,193 @@
+#include "compiler/patternResolver.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace tbx {
+
+static bool isIdentifierCharacter(char character) {
+  return std::isalnum(character) || character == '_';
+}
+
+// Extract the identifier portion from a pattern word
+// e.g., "number%" -> "number", "var's" -> "var", "count" -> "count"
+static std::string extractIdentifierFromWord(const std::string &word) {
+  size_t end = 0;
+  while (end < word.size() && isIdentifierCharacter(word[end])) {
+    end++;
+  }
+  return word.substr(0, end);
+}
+
+// ============================================================================
+// Resolution Worklist Implementation
+// ============================================================================
+
+void SectionPatternResolver::initializeWorklists() {
+  patternsByBody.clear();
+  dirtySections.clear();
+  dirtyPatterns.clear();
+  unresolvedLines.clear();
+  variableIndices.clear();
+  matchIdentifiers.clear();
+
+  // Every section is checked once; after that only when a line of it resolves
+  for (size_t sectionIndex = 0; sectionIndex < allSectionsData.size();
+       sectionIndex++) {
+    dirtySections.insert(dirtySections.end(), sectionIndex);
+  }
+
+  for (size_t patternIndex = 0; patternIndex < patternDefinitionsData.size();
+       patternIndex++) {
+    const ResolvedPattern *pattern = patternDefinitionsData[patternIndex].get();
+    if (pattern->body) {
+      patternsByBody[pattern->body].push_back(patternIndex);
+    }
+
+    // Split the pattern text once for variable propagation
+    PatternVariableIndex index;
+    index.originalWords = parsePatternWords(pattern->originalText);
+    for (const std::string &word : index.originalWords) {
+      index.wordIdentifiers.push_back(extractIdentifierFromWord(word));
+    }
+    index.variables.insert(pattern->variables.begin(),
+                           pattern->variables.end());
+    variableIndices.push_back(std::move(index));
+  }
+
+  // Every waiting line is tried once; after that only when the trees change
+  // in a way that could let it match
+  for (CodeLine *line : allLinesData) {
+    if (!line->isResolved && !line->isPatternDefinition) {
+      unresolvedLines.push_back(line);
+    }
+  }
+  retryAllLines = true;
+}
+
+std::vector<CodeLine *> SectionPatternResolver::linesToRetry(
+    const std::vector<ResolvedPattern *> &changedPatterns) {
+  std::vector<CodeLine *> lines;
+
+  if (retryAllLines) {
+    retryAllLines = false;
+    for (CodeLine *line : unresolvedLines) {
+      if (!line->isResolved) {
+        lines.push_back(line);
+      }
+    }
+    return lines;
+  }
+
+  // Lines are only matched against the effect and section trees. Lines
+  // without a child section only consult the effect tree.
+  std::vector<std::vector<std::string>> effectWords;
+  std::vector<std::vector<std::string>> sectionWords;
+  for (const ResolvedPattern *pattern : changedPatterns) {
+    if (pattern->type == PatternType::Effect) {
+      effectWords.push_back(
+          PatternTree::requiredLiteralWords(pattern->pattern));
+    } else if (pattern->type == PatternType::Section) {
+      sectionWords.push_back(
+          PatternTree::requiredLiteralWords(pattern->pattern));
+    }
+  }
+  if (effectWords.empty() && sectionWords.empty()) {
+    return lines;
+  }
+
+  auto couldMatchAny = [](const std::string &text,
+                          const std::vector<std::vector<std::string>> &words) {
+    for (const auto &patternWords : words) {
+      bool containsAll = true;
+      for (const std::string &word : patternWords) {
+        if (text.find(word) == std::string::npos) {
+          containsAll = false;
+          break;
+        }
+      }
+      if (containsAll) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  for (CodeLine *line : unresolvedLines) {
+    if (line->isResolved) {
+      continue;
+    }
+    if (couldMatchAny(line->text, effectWords) ||
+        (line->hasChildSection() && couldMatchAny(line->text, sectionWords))) {
+      lines.push_back(line);
+    }
+  }
+  return lines;
+}
+
+const std::vector<std::unordered_set<std::string>> &
+SectionPatternResolver::argumentIdentifiers(const PatternMatch *match) {
+  auto cached = matchIdentifiers.find(match);
+  if (cached != matchIdentifiers.end()) {
+    return cached->second;
+  }
+
+  // An identifier occurs in an argument as a maximal run of identifier
+  // characters: "val" occurs in "var + val" but not in "value"
+  std::vector<std::unordered_set<std::string>> identifiers;
+  for (const auto &[varName, info] : match->arguments) {
+    const auto *text = std::get_if<std::string>(&info.value);
+    if (!text)
+      continue;
+    std::unordered_set<std::string> argument;
+    size_t charIndex = 0;
+    while (charIndex < text->size()) {
+      if (!isIdentifierCharacter((*text)[charIndex])) {
+        charIndex++;
+        continue;
+      }
+      size_t start = charIndex;
+      while (charIndex < text->size() &&
+             isIdentifierCharacter((*text)[charIndex])) {
+        charIndex++;
+      }
+      argument.insert(text->substr(start, charIndex - start));
+    }
+    identifiers.push_back(std::move(argument));
+  }
+  return matchIdentifiers.emplace(match, std::move(identifiers)).first->second;
+}
+
+void SectionPatternResolver::markLineResolved(const CodeLine *line) {
+  if (!line || !line->parentSection) {
+    return;
+  }
+  size_t sectionIndex = line->parentSection->index;
+  if (sectionIndex < allSectionsData.size() &&
+      allSectionsData[sectionIndex] == line->parentSection) {
+    dirtySections.insert(sectionIndex);
+  }
+}
+
+void SectionPatternResolver::markLineMatched(const CodeLine *line) {
+  markLineResolved(line);
+  if (!line || !line->parentSection) {
+    return;
+  }
+
+  // Variable propagation reads body lines and the lines of their execute:,
+  // get:, ... subsections, so the owning pattern is at most one section up
+  auto markBody = [this](const Section *body) {
+    auto bodyPatterns = patternsByBody.find(body);
+    if (bodyPatterns != patternsByBody.end()) {
+      dirtyPatterns.insert(bodyPatterns->second.begin(),
+                           bodyPatterns->second.end());
+    }
+  };
+  markBody(line->parentSection);
+  if (line->parentSection->parent) {
+    markBody(line->parentSection->parent);
+  }
+}
+
+} // namespace tbx
@@ -12,26 +12,114 @@ namespace tbx {
 // PatternTree Implementation
 // ============================================================================
 
-PatternTree::PatternTree() = default;
+PatternTree::PatternTree() { nodes.emplace_back(); }
 
 void PatternTree::clear() {
-  rootNode = PatternTreeNode();
+  nodes.clear();
+  freeNodes.clear();
+  nodes.emplace_back();
   expressionPatterns.clear();
+  expressionPatternTrees.clear();
+  patternEntries.clear();
+  nextPatternOrder = 0;
+  operatorTable.clear();
+  candidateFilter.clear();
+  candidateFilterStale = false;
 }
 
 void PatternTree::addPattern(ResolvedPattern *pattern) {
   if (!pattern)
     return;
 
+  // A re-added pattern keeps its original rank so that it ends up in the same
+  // place a full rebuild would put it
+  auto existing = patternEntries.find(pattern);
+  size_t order = existing != patternEntries.end() ? existing->second.order
+                                                  : nextPatternOrder++;
+  removePattern(pattern);
+  patternEntries[pattern] = PatternTreeEntry{order, pattern->pattern};
+  candidateFilterStale = true;
+
   // Track expression patterns separately for recursive matching
   if (pattern->type == PatternType::Expression) {
-    expressionPatterns.push_back(pattern);
+    auto position = std::lower_bound(
+        expressionPatterns.begin(), expressionPatterns.end(), order,
+        [this](const ResolvedPattern *other, size_t rank) {
+          return patternOrder(other) < rank;
+        });
+    size_t index = position - expressionPatterns.begin();
+    expressionPatterns.insert(position, pattern);
+    expressionPatternTrees.insert(expressionPatternTrees.begin() + index,
+                                  compileExpressionPattern(pattern));
+  }
+
+  std::vector<PatternToken> tokens;
+  if (parsePatternTokens(pattern->pattern, tokens)) {
+    addPatternGraph(tokens, pattern);
+    return;
+  }
+  for (const auto &elements : expandPatternPaths(pattern->pattern)) {
+    addPatternPath(elements, pattern);
+  }
+}
+
+void PatternTree::removePattern(ResolvedPattern *pattern) {
+  auto entry = patternEntries.find(pattern);
+  if (entry == patternEntries.end())
+    return;
+
+  auto position =
+      std::find(expressionPatterns.begin(), expressionPatterns.end(), pattern);
+  if (position != expressionPatterns.end()) {
+    expressionPatternTrees.erase(expressionPatternTrees.begin() +
+                                 (position - expressionPatterns.begin()));
+    expressionPatterns.erase(position);
   }
 
+  // Walk the paths of the string the pattern was added with, which may differ
+  // from its current pattern string
+  std::vector<PatternToken> tokens;
+  if (parsePatternTokens(entry->second.insertedPattern, tokens)) {
+    removePatternGraph(tokens, pattern);
+  } else {
+    for (const auto &elements :
+         expandPatternPaths(entry->second.insertedPattern)) {
+      removePatternPath(elements, pattern);
+    }
+  }
+
+  patternEntries.erase(entry);
+  candidateFilterStale = true;
+}
+
+bool PatternTree::updatePattern(ResolvedPattern *pattern) {
+  if (!pattern)
+    return false;
+
+  auto entry = patternEntries.find(pattern);
+  if (entry != patternEntries.end() &&
+      entry->second.insertedPattern == pattern->pattern) {
+    return false;
+  }
+
+  addPattern(pattern);
+  return true;
+}
+
+size_t PatternTree::patternOrder(const ResolvedPattern *pattern) const {
+  auto entry = patternEntries.find(pattern);
+  return entry != patternEntries.end() ? entry->second.order
+                                       : static_cast<size_t>(-1);
+}
+
+std::vector<std::vector<PatternElement>>
+PatternTree::expandPatternPaths(const std::string &patternText) {
+  std::vector<std::vector<PatternElement>> paths;
+
   // Expand alternatives in the pattern (the one with $ slots)
-  std::vector<std::string> expanded = expandAlternatives(pattern->pattern);
+  std::vector<std::string> expanded = expandAlternatives(patternText);
 
-  // For each expanded variant, parse into elements and add to tree
+  // For each expanded variant, parse into elements
   for (const auto &variant : expanded) {
     // Trim leading whitespace from variant (handles empty alternatives like
     // [|loop])
@@ -45,10 +133,20 @@ void PatternTree::addPattern(ResolvedPattern *pattern) {
     }
 
     // Parse the expanded variant string directly
-    std::vector<PatternElement> elements =
-        parsePatternElementsFromString(trimmedVariant);
-    addPatternPath(elements, pattern);
+    paths.push_back(parsePatternElementsFromString(trimmedVariant));
   }
+
+  return paths;
+}
+
+std::unique_ptr<PatternTree>
+PatternTree::compileExpressionPattern(ResolvedPattern *pattern) {
+  // The compiled tree holds no expression patterns of its own, so $ slots
+  // inside it match plain text and literals, exactly like the temporary
+  // per-call trees this replaces
+  auto patternTree = std::make_unique<PatternTree>();
+  patternTree->addPatternPath(parsePatternElements(pattern), pattern);
+  return patternTree;
 }
 
 std::vector<PatternElement>
@@ -102,30 +200,8 @@ PatternTree::parsePatternElementsFromString(const std::string &text) {
     if (text[charIndex] == '{') {
       size_t braceEnd = text.find('}', charIndex);
       if (braceEnd != std::string::npos) {
-        std::string captureContent =
-            text.substr(charIndex + 1, braceEnd - charIndex - 1);
-        size_t colonPos = captureContent.find(':');
-
-        PatternElement elem;
-        if (colonPos != std::string::npos) {
-          // Typed capture: {type:name}
-          std::string captureTypeString = captureContent.substr(0, colonPos);
-          std::string captureNameString = captureContent.substr(colonPos + 1);
-
-          if (captureTypeString == "expression") {
-            elem.type = PatternElementType::ExpressionCapture;
-          } else if (captureTypeString == "word") {
-            elem.type = PatternElementType::WordCapture;
-          } else {
-            // Unknown type, treat as expression capture (legacy)
-            elem.type = PatternElementType::ExpressionCapture;
-          }
-          elem.captureName = captureNameString;
-        } else {
-          // Legacy syntax: {name} without type = expression capture
-          elem.type = PatternElementType::ExpressionCapture;
-          elem.captureName = captureContent;
-        }
+        PatternElement elem = parseCaptureElement(
+            text.substr(charIndex + 1, braceEnd - charIndex - 1));
 
         flushLiteral(true);
         elements.push_back(elem);
@@ -153,6 +229,33 @@ PatternTree::parsePatternElementsFromString(const std::string &text) {
   return elements;
 }
 
+PatternElement
+PatternTree::parseCaptureElement(const std::string &captureContent) {
+  size_t colonPos = captureContent.find(':');
+
+  PatternElement elem;
+  if (colonPos != std::string::npos) {
+    // Typed capture: {type:name}
+    std::string captureTypeString = captureContent.substr(0, colonPos);
+    std::string captureNameString = captureContent.substr(colonPos + 1);
+
+    if (captureTypeString == "expression") {
+      elem.type = PatternElementType::ExpressionCapture;
+    } else if (captureTypeString == "word") {
+      elem.type = PatternElementType::WordCapture;
+    } else {
+      // Unknown type, treat as expression capture (legacy)
+      elem.type = PatternElementType::ExpressionCapture;
+    }
+    elem.captureName = captureNameString;
+  } else {
+    // Legacy syntax: {name} without type = expression capture
+    elem.type = PatternElementType::ExpressionCapture;
+    elem.captureName = captureContent;
+  }
+  return elem;
+}
+
 std::vector<std::string>
 PatternTree::expandAlternatives(const std::string &patternText) {
   std::vector<std::string> results;
@@ -223,172 +326,383 @@ PatternTree::expandAlternatives(const std::string &patternText) {
   return results;
 }
 
-void PatternTree::addPatternPath(const std::vector<PatternElement> &elements,
-                                 ResolvedPattern *pattern) {
-  PatternTreeNode *node = &rootNode;
+uint32_t PatternTree::allocateNode() {
+  if (!freeNodes.empty()) {
+    uint32_t nodeIndex = freeNodes.back();
+    freeNodes.pop_back();
+    return nodeIndex;
+  }
+  nodes.emplace_back();
+  return static_cast<uint32_t>(nodes.size() - 1);
+}
 
-  for (const auto &elem : elements) {
-    switch (elem.type) {
-    case PatternElementType::Literal: {
-      // Check if this literal child exists
-      auto it = node->children.find(elem.text);
-      if (it == node->children.end()) {
-        node->children[elem.text] = std::make_shared<PatternTreeNode>();
-      }
-      node = node->children[elem.text].get();
-      break;
+uint32_t PatternTree::findChild(uint32_t nodeIndex,
+                                const PatternElement &elem) const {
+  const PatternTreeNode &node = nodes[nodeIndex];
+  switch (elem.type) {
+  case PatternElementType::Literal: {
+    auto it = std::lower_bound(node.children.begin(), node.children.end(),
+                               elem.text,
+                               [](const PatternTreeEdge &edge,
+                                  const std::string &literal) {
+                                 return edge.literal < literal;
+                               });
+    if (it != node.children.end() && it->literal == elem.text) {
+      return it->child;
     }
-    case PatternElementType::Variable: {
-      // Create or follow expression child (eager evaluation)
-      if (!node->expressionChild) {
-        node->expressionChild = std::make_shared<PatternTreeNode>();
-      }
-      node = node->expressionChild.get();
-      break;
+    return PatternTreeNode::noNode;
+  }
+  case PatternElementType::Variable:
+    return node.expressionChild;
+  case PatternElementType::ExpressionCapture:
+    return node.expressionCaptureChild;
+  case PatternElementType::WordCapture:
+    return node.wordCaptureChild;
+  }
+  return PatternTreeNode::noNode;
+}
+
+uint32_t PatternTree::addChild(uint32_t nodeIndex,
+                               const PatternElement &elem) {
+  uint32_t existing = findChild(nodeIndex, elem);
+  if (existing != PatternTreeNode::noNode) {
+    return existing;
+  }
+
+  uint32_t child = allocateNode();
+  linkChild(nodeIndex, elem, child);
+  return child;
+}
+
+void PatternTree::linkChild(uint32_t nodeIndex, const PatternElement &elem,
+                            uint32_t child) {
+  uint32_t previous = findChild(nodeIndex, elem);
+  if (previous == child)
+    return;
+  if (previous != PatternTreeNode::noNode) {
+    nodes[previous].parentCount--;
+  }
+  nodes[child].parentCount++;
+
+  PatternTreeNode &node = nodes[nodeIndex];
+  switch (elem.type) {
+  case PatternElementType::Literal: {
+    // Keep literal children sorted so lookups can binary search
+    auto it = std::lower_bound(node.children.begin(), node.children.end(),
+                               elem.text,
+                               [](const PatternTreeEdge &edge,
+                                  const std::string &literal) {
+                                 return edge.literal < literal;
+                               });
+    if (it != node.children.end() && it->literal == elem.text) {
+      it->child = child;
+    } else {
+      node.children.insert(it, PatternTreeEdge{elem.text, child});
+      node.literalFirstBytes.set(static_cast<unsigned char>(elem.text[0]));
     }
-    case PatternElementType::ExpressionCapture: {
-      // Create or follow expression capture child (lazy, greedy)
-      if (!node->expressionCaptureChild) {
-        node->expressionCaptureChild = std::make_shared<PatternTreeNode>();
-      }
-      node = node->expressionCaptureChild.get();
-      break;
+    break;
+  }
+  case PatternElementType::Variable:
+    // Expression child (eager evaluation)
+    node.expressionChild = child;
+    break;
+  case PatternElementType::ExpressionCapture:
+    // Expression capture child (lazy, greedy)
+    node.expressionCaptureChild = child;
+    break;
+  case PatternElementType::WordCapture:
+    // Word capture child (non-greedy, single identifier)
+    node.wordCaptureChild = child;
+    break;
+  }
+}
+
+bool PatternTree::unlinkChild(uint32_t nodeIndex, uint32_t child) {
+  PatternTreeNode &node = nodes[nodeIndex];
+  uint32_t removed = 0;
+  for (auto edge = node.children.begin(); edge != node.children.end();) {
+    if (edge->child == child) {
+      edge = node.children.erase(edge);
+      removed++;
+    } else {
+      ++edge;
     }
-    case PatternElementType::WordCapture: {
-      // Create or follow word capture child (non-greedy, single identifier)
-      if (!node->wordCaptureChild) {
-        node->wordCaptureChild = std::make_shared<PatternTreeNode>();
-      }
-      node = node->wordCaptureChild.get();
-      break;
+  }
+  if (removed > 0) {
+    // Keep only the first bytes other children still start with
+    node.literalFirstBytes.reset();
+    for (const auto &edge : node.children) {
+      node.literalFirstBytes.set(static_cast<unsigned char>(edge.literal[0]));
     }
+  }
+  for (uint32_t *slot : {&node.expressionChild, &node.expressionCaptureChild,
+                         &node.wordCaptureChild}) {
+    if (*slot == child) {
+      *slot = PatternTreeNode::noNode;
+      removed++;
     }
   }
+  if (removed == 0)
+    return false;
 
-  // Mark pattern as ending here
-  node->patternsEndedHere.push_back(pattern);
+  nodes[child].parentCount -= removed;
+  if (nodes[child].parentCount == 0) {
+    nodes[child] = PatternTreeNode();
+    freeNodes.push_back(child);
+  }
+  return true;
 }
 
-std::optional<TreePatternMatch> PatternTree::match(const std::string &input,
-                                                   size_t startPos) {
-  std::vector<MatchedValue> arguments;
-  std::vector<TreePatternMatch> matches;
+uint32_t PatternTree::cloneNode(uint32_t nodeIndex) {
+  // Allocate first: growing the arena invalidates references into it
+  uint32_t copy = allocateNode();
+  nodes[copy] = nodes[nodeIndex];
+  nodes[copy].parentCount = 0;
 
-  matchRecursive(&rootNode, input, startPos, arguments, matches);
+  PatternTreeNode &node = nodes[copy];
+  for (const auto &edge : node.children) {
+    nodes[edge.child].parentCount++;
+  }
+  for (uint32_t child : {node.expressionChild, node.expressionCaptureChild,
+                         node.wordCaptureChild}) {
+    if (child != PatternTreeNode::noNode) {
+      nodes[child].parentCount++;
+    }
+  }
+  return copy;
+}
 
-  if (matches.empty()) {
-    return std::nullopt;
+void PatternTree::addPatternPath(const std::vector<PatternElement> &elements,
+                                 ResolvedPattern *pattern) {
+  // Every node on the path can now reach this pattern
+  int specificity = pattern->specificity();
+  size_t order = patternOrder(pattern);
+  uint32_t nodeIndex = rootIndex;
+  nodes[nodeIndex].maxSpecificity =
+      std::max(nodes[nodeIndex].maxSpecificity, specificity);
+  addPatternSlot(nodes[nodeIndex].patternMask, order);
+  for (const auto &elem : elements) {
+    uint32_t child = findChild(nodeIndex, elem);
+    if (child == PatternTreeNode::noNode) {
+      child = addChild(nodeIndex, elem);
+    } else if (nodes[child].parentCount > 1) {
+      // The child is where the branches of another pattern's [a|b] group
+      // meet; continue from a copy reached only through this path
+      uint32_t copy = cloneNode(child);
+      linkChild(nodeIndex, elem, copy);
+      child = copy;
+    }
+    nodeIndex = child;
+    nodes[nodeIndex].maxSpecificity =
+        std::max(nodes[nodeIndex].maxSpecificity, specificity);
+    addPatternSlot(nodes[nodeIndex].patternMask, order);
   }
 
-  // Return best match (highest specificity, or longest consumed if equal)
-  auto best = std::max_element(
-      matches.begin(), matches.end(),
-      [](const TreePatternMatch &leftMatch,
-         const TreePatternMatch &rightMatch) {
-        int specLeft = leftMatch.pattern ? leftMatch.pattern->specificity() : 0;
-        int specRight =
-            rightMatch.pattern ? rightMatch.pattern->specificity() : 0;
-        if (specLeft != specRight)
-          return specLeft < specRight;
-        return leftMatch.consumedLength < rightMatch.consumedLength;
+  // Mark pattern as ending here, ordered by insertion rank
+  auto &ended = nodes[nodeIndex].patternsEndedHere;
+  auto position = std::upper_bound(
+      ended.begin(), ended.end(), order,
+      [this](size_t rank, const ResolvedPattern *other) {
+        return rank < patternOrder(other);
       });
+  ended.insert(position, pattern);
+}
+
+void PatternTree::removePatternPath(const std::vector<PatternElement> &elements,
+                                    ResolvedPattern *pattern) {
+  // Follow the path, remembering each node on it
+  std::vector<uint32_t> pathNodes = {rootIndex};
+  for (const auto &elem : elements) {
+    uint32_t next = findChild(pathNodes.back(), elem);
+    if (next == PatternTreeNode::noNode)
+      return;
+    pathNodes.push_back(next);
+  }
+
+  auto &ended = nodes[pathNodes.back()].patternsEndedHere;
+  ended.erase(std::remove(ended.begin(), ended.end(), pattern), ended.end());
 
-  return *best;
+  // Prune nodes that no longer lead anywhere, deepest first
+  size_t depth = elements.size();
+  while (depth > 0 && nodes[pathNodes[depth]].isEmpty()) {
+    unlinkChild(pathNodes[depth - 1], pathNodes[depth]);
+    depth--;
+  }
+
+  // Tighten the bounds of the remaining path
+  for (size_t remaining = depth + 1; remaining > 0; remaining--) {
+    refreshBounds(pathNodes[remaining - 1]);
+  }
 }
 
-std::optional<TreePatternMatch>
-PatternTree::matchExpression(const std::string &input, size_t startPos) {
-  // Only match expression patterns
-  std::vector<TreePatternMatch> matches;
-
-  // Try each expression pattern
-  for (auto *pattern : expressionPatterns) {
-    // Build a temporary tree with just this pattern
-    PatternTree tempTree;
-    std::vector<PatternElement> elements = parsePatternElements(pattern);
-
-    PatternTreeNode *node = &tempTree.rootNode;
-    for (const auto &elem : elements) {
-      switch (elem.type) {
-      case PatternElementType::Literal: {
-        if (node->children.find(elem.text) == node->children.end()) {
-          node->children[elem.text] = std::make_shared<PatternTreeNode>();
-        }
-        node = node->children[elem.text].get();
-        break;
-      }
-      case PatternElementType::Variable: {
-        if (!node->expressionChild) {
-          node->expressionChild = std::make_shared<PatternTreeNode>();
-        }
-        node = node->expressionChild.get();
-        break;
-      }
-      case PatternElementType::ExpressionCapture: {
-        if (!node->expressionCaptureChild) {
-          node->expressionCaptureChild = std::make_shared<PatternTreeNode>();
-        }
-        node = node->expressionCaptureChild.get();
-        break;
-      }
-      case PatternElementType::WordCapture: {
-        if (!node->wordCaptureChild) {
-          node->wordCaptureChild = std::make_shared<PatternTreeNode>();
-        }
-        node = node->wordCaptureChild.get();
-        break;
-      }
-      }
+bool PatternTree::refreshBounds(uint32_t nodeIndex) {
+  PatternTreeNode &node = nodes[nodeIndex];
+  int bound = -1;
+  std::vector<uint64_t> mask;
+  for (const auto *pattern : node.patternsEndedHere) {
+    bound = std::max(bound, pattern->specificity());
+    addPatternSlot(mask, patternOrder(pattern));
+  }
+  for (const auto &edge : node.children) {
+    bound = std::max(bound, nodes[edge.child].maxSpecificity);
+    PatternCandidateFilter::mergeSlots(mask, nodes[edge.child].patternMask);
+  }
+  for (uint32_t child : {node.expressionChild, node.expressionCaptureChild,
+                         node.wordCaptureChild}) {
+    if (child != PatternTreeNode::noNode) {
+      bound = std::max(bound, nodes[child].maxSpecificity);
+      PatternCandidateFilter::mergeSlots(mask, nodes[child].patternMask);
     }
-    node->patternsEndedHere.push_back(pattern);
+  }
+  bool changed = bound != node.maxSpecificity || mask != node.patternMask;
+  node.maxSpecificity = bound;
+  node.patternMask = std::move(mask);
+  return changed;
+}
 
-    // Match against this pattern
-    std::vector<MatchedValue> args;
-    std::vector<TreePatternMatch> patternMatchesFound;
-    tempTree.matchRecursive(&tempTree.rootNode, input, startPos, args,
-                            patternMatchesFound);
+void PatternTree::addPatternSlot(std::vector<uint64_t> &mask, size_t order) {
+  if (order != static_cast<size_t>(-1)) {
+    PatternCandidateFilter::addSlot(mask, order);
+  }
+}
 
-    for (auto &m : patternMatchesFound) {
-      matches.push_back(std::move(m));
-    }
+void PatternTree::refreshCandidateFilter() {
+  if (!candidateFilterStale.load())
+    return;
+  std::lock_guard<std::mutex> lock(candidateFilterMutex);
+  if (!candidateFilterStale.load())
+    return;
+
+  candidateFilter.clear();
+  for (const auto &entry : patternEntries) {
+    candidateFilter.addPattern(
+        entry.second.order, requiredLiteralWords(entry.second.insertedPattern));
   }
+  candidateFilter.build();
+  candidateFilterStale = false;
+}
 
-  if (matches.empty()) {
-    return std::nullopt;
+std::optional<TreePatternMatch> PatternTree::match(const std::string &input,
+                                                   size_t startPos) {
+  std::vector<PendingArgument> arguments;
+  TreeMatchSearch search;
+
+  // Only patterns whose required words all occur in the line can match
+  refreshCandidateFilter();
+  std::vector<uint64_t> candidatePatterns = candidateFilter.candidates(input);
+  search.candidatePatterns = &candidatePatterns;
+
+  // Best match: highest specificity, or longest consumed if equal
+  matchRecursive(rootIndex, input, startPos, arguments, search);
+  nodesVisitedCount += search.nodesVisited;
+
+  return std::move(search.best);
+}
+
+std::optional<TreePatternMatch>
+PatternTree::matchExpression(const std::string &input, size_t startPos) {
+  // Only match expression patterns. The search is shared, so each path only
+  // explores what could beat the best match of the paths before it.
+  TreeMatchSearch search;
+
+  // Seed the search with the precedence split. It consumes the whole input,
+  // so only a more specific pattern can replace it.
+  search.best = matchInfix(input, startPos);
+  if (search.best) {
+    search.bestSpecificity = search.best->pattern->specificity();
   }
 
-  // Return best match
-  auto best = std::max_element(
-      matches.begin(), matches.end(),
-      [](const TreePatternMatch &leftMatch,
-         const TreePatternMatch &rightMatch) {
-        int specLeft = leftMatch.pattern ? leftMatch.pattern->specificity() : 0;
-        int specRight =
-            rightMatch.pattern ? rightMatch.pattern->specificity() : 0;
-        if (specLeft != specRight)
-          return specLeft < specRight;
-        return leftMatch.consumedLength < rightMatch.consumedLength;
-      });
+  // Try each expression pattern against its precompiled path
+  for (auto &patternTree : expressionPatternTrees) {
+    std::vector<PendingArgument> args;
+    patternTree->matchRecursive(rootIndex, input, startPos, args, search);
+  }
+  nodesVisitedCount += search.nodesVisited;
+
+  return std::move(search.best);
+}
+
+std::optional<TreePatternMatch>
+PatternTree::matchInfix(const std::string &input, size_t startPos) {
+  size_t operatorPos = 0;
+  const InfixOperator *infixOperator =
+      operatorTable.findSplit(input, startPos, operatorPos);
+  if (!infixOperator)
+    return std::nullopt;
+
+  std::string_view text(input);
+  size_t rightStart = operatorPos + infixOperator->spelling.size();
+
+  TreePatternMatch matchFound;
+  matchFound.pattern = infixOperator->pattern;
+  matchFound.arguments.push_back(
+      operandValue(text.substr(startPos, operatorPos - startPos)));
+  matchFound.arguments.push_back(operandValue(text.substr(rightStart)));
+  matchFound.consumedLength = input.size();
+  return matchFound;
+}
+
+MatchedValue PatternTree::operandValue(std::string_view text) {
+  auto literalValue = tryParseLiteral(text);
+  std::vector<PendingArgument> operand = {
+      literalValue ? std::move(*literalValue) : PendingArgument(text)};
+  return std::move(materializeArguments(operand).front());
+}
+
+bool PatternTree::canImproveOn(const PatternTreeNode &node,
+                               const TreeMatchSearch &search,
+                               const std::string &input) {
+  if (node.maxSpecificity < 0)
+    return false; // No pattern ends at or below this node
+  if (search.candidatePatterns &&
+      !PatternCandidateFilter::sharesSlot(node.patternMask,
+                                          *search.candidatePatterns))
+    return false; // None of them can match this line
+  if (!search.best)
+    return true;
+  if (node.maxSpecificity != search.bestSpecificity)
+    return node.maxSpecificity > search.bestSpecificity;
+  return search.best->consumedLength < input.size();
+}
+
+void PatternTree::recordMatch(ResolvedPattern *pattern, size_t pos,
+                              const std::vector<PendingArgument> &arguments,
+                              TreeMatchSearch &search) {
+  int specificity = pattern ? pattern->specificity() : 0;
+  if (search.best) {
+    if (specificity < search.bestSpecificity)
+      return;
+    if (specificity == search.bestSpecificity &&
+        pos <= search.best->consumedLength)
+      return;
+  }
 
-  return *best;
+  TreePatternMatch matchFound;
+  matchFound.pattern = pattern;
+  matchFound.arguments = materializeArguments(arguments);
+  matchFound.consumedLength = pos;
+  search.best = std::move(matchFound);
+  search.bestSpecificity = specificity;
 }
 
-void PatternTree::matchRecursive(PatternTreeNode *node,
-                                 const std::string &input, size_t pos,
-                                 std::vector<MatchedValue> &arguments,
-                                 std::vector<TreePatternMatch> &matches) {
-  if (!node)
+void PatternTree::matchRecursive(uint32_t nodeIndex, const std::string &input,
+                                 size_t pos,
+                                 std::vector<PendingArgument> &arguments,
+                                 TreeMatchSearch &search) {
+  if (nodeIndex == PatternTreeNode::noNode)
     return;
 
+  // The arena is not modified while matching, so this reference stays valid
+  const PatternTreeNode *node = &nodes[nodeIndex];
+
+  // Bound: skip subtrees that cannot produce a better match
+  if (!canImproveOn(*node, search, input))
+    return;
+  search.nodesVisited++;
+
   // Check if patterns end here
-  if (!node->patternsEndedHere.empty()) {
-    for (auto *pattern : node->patternsEndedHere) {
-      TreePatternMatch matchFound;
-      matchFound.pattern = pattern;
-      matchFound.arguments = arguments;
-      matchFound.consumedLength = pos;
-      matches.push_back(std::move(matchFound));
-    }
+  for (auto *pattern : node->patternsEndedHere) {
+    recordMatch(pattern, pos, arguments, search);
   }
 
   // If we've consumed all input, we're done
@@ -396,56 +710,62 @@ void PatternTree::matchRecursive(PatternTreeNode *node,
     return;
   }
 
-  // Try literal children (most specific first)
-  for (const auto &[literal, child] : node->children) {
-    // Check if input starts with this literal at current position
-    if (pos + literal.size() <= input.size() &&
-        input.substr(pos, literal.size()) == literal) {
-      matchRecursive(child.get(), input, pos + literal.size(), arguments,
-                     matches);
+  // Try literal children (most specific first). Only the run of children
+  // starting with the next input byte can match.
+  char nextByte = input[pos];
+  if (node->literalFirstBytes.test(static_cast<unsigned char>(nextByte))) {
+    auto edge = std::lower_bound(
+        node->children.begin(), node->children.end(), nextByte,
+        [](const PatternTreeEdge &candidate, char firstByte) {
+          return static_cast<unsigned char>(candidate.literal[0]) <
+                 static_cast<unsigned char>(firstByte);
+        });
+    for (; edge != node->children.end() && edge->literal[0] == nextByte;
+         ++edge) {
+      // Check if input starts with this literal at current position
+      if (input.compare(pos, edge->literal.size(), edge->literal) == 0) {
+        matchRecursive(edge->child, input, pos + edge->literal.size(),
+                       arguments, search);
+      }
     }
   }
 
-  // Try expression child ($ variable substitution - eager, greedy)
-  if (node->expressionChild) {
-    // Find possible expression boundaries
-    std::vector<size_t> boundaries = findExpressionBoundaries(input, pos);
+  // Try expression child ($ variable substitution - eager, greedy). Checking
+  // the bound first skips the sub-expression work for pruned subtrees.
+  if (node->expressionChild != PatternTreeNode::noNode &&
+      canImproveOn(nodes[node->expressionChild], search, input)) {
+    // Try to match as a sub-expression first. This only depends on pos, so it
+    // is done once rather than once per candidate boundary.
+    auto subMatch = tryMatchExpressionAt(input, pos);
+    if (subMatch) {
+      size_t subEnd = pos + subMatch->matchedText.size();
+      matchWithArgument(node->expressionChild, input, subEnd,
+                        std::move(subMatch), arguments, search);
+    }
 
-    for (size_t end : boundaries) {
-      if (end <= pos)
+    // Try every expression boundary, longest first (greedy)
+    for (size_t end = input.size(); end > pos; end--) {
+      if (end != input.size() && !isExpressionBoundary(input[end]))
         continue;
 
-      std::string exprText = input.substr(pos, end - pos);
-
-      // Try to match as a sub-expression first
-      auto subMatch = tryMatchExpressionAt(input, pos);
-      if (subMatch) {
-        std::vector<MatchedValue> newArgs = arguments;
-        newArgs.push_back(
-            std::make_shared<ExpressionMatch>(std::move(*subMatch)));
-        matchRecursive(node->expressionChild.get(), input,
-                       pos + subMatch->matchedText.size(), newArgs, matches);
-      }
+      std::string_view exprText(input.data() + pos, end - pos);
 
       // Also try as a literal value
       auto literalValue = tryParseLiteral(exprText);
       if (literalValue) {
-        std::vector<MatchedValue> newArgs = arguments;
-        newArgs.push_back(*literalValue);
-        matchRecursive(node->expressionChild.get(), input, end, newArgs,
-                       matches);
+        matchWithArgument(node->expressionChild, input, end,
+                          std::move(*literalValue), arguments, search);
       }
 
       // Try as a plain identifier/string
-      std::vector<MatchedValue> newArgs = arguments;
-      newArgs.push_back(exprText);
-      matchRecursive(node->expressionChild.get(), input, end, newArgs, matches);
+      matchWithArgument(node->expressionChild, input, end, exprText,
+                        arguments, search);
     }
   }
 
   // Try expression capture child ({expression:name} - lazy, greedy, caller's
   // scope)
-  if (node->expressionCaptureChild) {
+  if (node->expressionCaptureChild != PatternTreeNode::noNode) {
     // For expression captures, find the end of the expression (usually : or end
     // of line) This is greedy - capture as much as possible
     size_t end = input.find(':', pos);
@@ -458,16 +778,14 @@ void PatternTree::matchRecursive(PatternTreeNode *node,
       end--;
     }
 
-    std::string captured = input.substr(pos, end - pos);
-    std::vector<MatchedValue> newArgs = arguments;
-    newArgs.push_back(
-        captured); // Store as string (lazy - will be re-parsed later)
-    matchRecursive(node->expressionCaptureChild.get(), input, end, newArgs,
-                   matches);
+    // Store as string (lazy - will be re-parsed later)
+    std::string_view captured(input.data() + pos, end - pos);
+    matchWithArgument(node->expressionCaptureChild, input, end, captured,
+                      arguments, search);
   }
 
   // Try word capture child ({word:name} - non-greedy, single identifier)
-  if (node->wordCaptureChild) {
+  if (node->wordCaptureChild != PatternTreeNode::noNode) {
     // For word captures, match only a single identifier (non-greedy)
     size_t end = pos;
 
@@ -484,67 +802,73 @@ void PatternTree::matchRecursive(PatternTreeNode *node,
     }
 
     if (end > wordStart) {
-      std::string word = input.substr(wordStart, end - wordStart);
-      std::vector<MatchedValue> newArgs = arguments;
-      newArgs.push_back(word); // Store as string literal
-      matchRecursive(node->wordCaptureChild.get(), input, end, newArgs,
-                     matches);
+      // Store as string literal
+      std::string_view word(input.data() + wordStart, end - wordStart);
+      matchWithArgument(node->wordCaptureChild, input, end, word, arguments,
+                        search);
     }
   }
 }
 
-std::optional<ExpressionMatch>
-PatternTree::tryMatchExpressionAt(const std::string &input, size_t pos) {
-  // Try to match any expression pattern at this position
-  // This delegates to matchExpression which handles recursive matching
+void PatternTree::matchWithArgument(uint32_t nodeIndex,
+                                    const std::string &input, size_t pos,
+                                    PendingArgument argument,
+                                    std::vector<PendingArgument> &arguments,
+                                    TreeMatchSearch &search) {
+  arguments.push_back(std::move(argument));
+  matchRecursive(nodeIndex, input, pos, arguments, search);
+  arguments.pop_back();
+}
+
+std::vector<MatchedValue> PatternTree::materializeArguments(
+    const std::vector<PendingArgument> &arguments) {
+  std::vector<MatchedValue> values;
+  values.reserve(arguments.size());
+  for (const auto &argument : arguments) {
+    if (auto *text = std::get_if<std::string_view>(&argument)) {
+      values.emplace_back(std::string(*text));
+    } else if (auto *integer = std::get_if<int64_t>(&argument)) {
+      values.emplace_back(*integer);
+    } else if (auto *number = std::get_if<double>(&argument)) {
+      values.emplace_back(*number);
+    } else {
+      values.emplace_back(std::get<std::shared_ptr<ExpressionMatch>>(argument));
+    }
+  }
+  return values;
+}
 
+std::shared_ptr<ExpressionMatch>
+PatternTree::tryMatchExpressionAt(const std::string &input, size_t pos) {
+  // Try to match any expression pattern at this position. The compiled
+  // pattern paths hold no expression patterns, so this never recurses.
   if (expressionPatterns.empty()) {
-    return std::nullopt;
+    return nullptr;
   }
 
   // Use matchExpression to find the best expression match
   auto treeMatch = matchExpression(input, pos);
 
-  if (!treeMatch || !treeMatch->pattern) {
-    return std::nullopt;
+  std::shared_ptr<ExpressionMatch> result;
+  if (treeMatch && treeMatch->pattern) {
+    // Convert TreePatternMatch to ExpressionMatch
+    result = std::make_shared<ExpressionMatch>();
+    result->pattern = treeMatch->pattern;
+    result->matchedText = input.substr(pos, treeMatch->consumedLength - pos);
+    result->arguments = std::move(treeMatch->arguments);
   }
 
-  // Convert TreePatternMatch to ExpressionMatch
-  ExpressionMatch result;
-  result.pattern = treeMatch->pattern;
-  result.matchedText = input.substr(pos, treeMatch->consumedLength - pos);
-  result.arguments = treeMatch->arguments;
-
   return result;
 }
 
-std::vector<size_t>
-PatternTree::findExpressionBoundaries(const std::string &input, size_t start) {
-  std::vector<size_t> boundaries;
-
-  // Try progressively longer substrings
-  for (size_t end = start + 1; end <= input.size(); end++) {
-    // Check if this could be a valid expression boundary
-    if (end == input.size()) {
-      boundaries.push_back(end);
-    } else if (isExpressionBoundary(input[end])) {
-      boundaries.push_back(end);
-    }
-  }
-
-  // Return in reverse order (longest first) for greedy matching
-  std::reverse(boundaries.begin(), boundaries.end());
-  return boundaries;
-}
-
 bool PatternTree::isExpressionBoundary(char character) const {
   // Expression boundaries: whitespace, operators, punctuation
   return std::isspace(character) || character == ':' || character == ',' ||
          character == ')' || character == ']';
 }
 
-std::optional<MatchedValue>
-PatternTree::tryParseLiteral(const std::string &text) {
+std::optional<PendingArgument>
+PatternTree::tryParseLiteral(std::string_view text) {
   if (text.empty())
     return std::nullopt;
 
@@ -566,10 +890,12 @@ PatternTree::tryParseLiteral(const std::string &text) {
   }
 
   if (isNumber && !text.empty() && text != "-" && text != ".") {
+    // Numbers are short, so this copy stays within the small-string buffer
+    std::string number(text);
     if (hasDot) {
-      return std::stod(text);
+      return std::stod(number);
     } else {
-      return std::stoll(text);
+      return static_cast<int64_t>(std::stoll(number));
     }
   }
 
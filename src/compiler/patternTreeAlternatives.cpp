@@ -0,0 +1,495 @@
+#include "compiler/patternTree.hpp"
+#include "compiler/resolvedPattern.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace tbx {
+
+static PatternElement literalElement(const std::string &text) {
+  PatternElement elem;
+  elem.type = PatternElementType::Literal;
+  elem.text = text;
+  return elem;
+}
+
+static bool sameElement(const std::optional<PatternElement> &first,
+                        const std::optional<PatternElement> &second) {
+  if (!first || !second) {
+    return !first && !second;
+  }
+  return first->type == second->type && first->text == second->text;
+}
+
+// Queue a cursor unless one at the same node in the same state already is
+static void queueCursor(std::vector<PatternPathCursor> &cursors,
+                        const PatternPathCursor &cursor) {
+  bool queued = std::any_of(cursors.begin(), cursors.end(),
+                            [&cursor](const PatternPathCursor &other) {
+                              return other.node == cursor.node &&
+                                     other.sameState(cursor);
+                            });
+  if (!queued) {
+    cursors.push_back(cursor);
+  }
+}
+
+// Feed one literal character to a cursor, the way
+// parsePatternElementsFromString() handles it in an expanded variant
+static void appendCharacter(PatternPathCursor &cursor, char character) {
+  // Skip the space after a capture
+  if (cursor.skipSpace) {
+    cursor.skipSpace = false;
+    if (character == ' ')
+      return;
+  }
+  // Leading spaces of a variant are trimmed
+  if (cursor.atStart) {
+    if (character == ' ') {
+      cursor.leadingSpaces += character;
+      return;
+    }
+    cursor.atStart = false;
+    cursor.leadingSpaces.clear();
+  }
+  // If we just finished a capture, add leading space
+  if (cursor.literal.empty() && cursor.afterCapture) {
+    cursor.literal = " ";
+  }
+  cursor.literal += character;
+}
+
+// Group cursors that are in the same state after a step, leaving out
+// cursors that repeat another's node and element
+static std::vector<std::vector<size_t>>
+groupCursors(const std::vector<PatternPathCursor> &cursors,
+             const std::vector<std::optional<PatternElement>> &emitted) {
+  std::vector<std::vector<size_t>> classes;
+  std::vector<bool> grouped(cursors.size(), false);
+  for (size_t first = 0; first < cursors.size(); first++) {
+    if (grouped[first])
+      continue;
+    std::vector<size_t> members;
+    for (size_t other = first; other < cursors.size(); other++) {
+      if (grouped[other] || !cursors[other].sameState(cursors[first]))
+        continue;
+      grouped[other] = true;
+      bool duplicate = std::any_of(
+          members.begin(), members.end(), [&](size_t member) {
+            return cursors[member].node == cursors[other].node &&
+                   sameElement(emitted[member], emitted[other]);
+          });
+      if (!duplicate) {
+        members.push_back(other);
+      }
+    }
+    classes.push_back(std::move(members));
+  }
+  return classes;
+}
+
+// ============================================================================
+// Pattern Tokens Implementation
+// ============================================================================
+
+bool PatternTree::parsePatternTokens(const std::string &text,
+                                     std::vector<PatternToken> &tokens) {
+  // expandPatternPaths() looks for the closing brace of a capture in each
+  // expanded variant; that only agrees with the tokens when no bracket or
+  // bar lies in between
+  for (size_t open = text.find('{'); open != std::string::npos;
+       open = text.find('{', open + 1)) {
+    size_t close = text.find('}', open);
+    if (close != std::string::npos &&
+        text.find_first_of("[]|", open) < close) {
+      return false;
+    }
+  }
+
+  std::vector<size_t> openGroups; // GroupOpen token of each unclosed [
+  std::vector<std::vector<size_t>> alternativeEnds; // Their | tokens
+  for (size_t charIndex = 0; charIndex < text.size(); charIndex++) {
+    char character = text[charIndex];
+    size_t braceEnd =
+        character == '{' ? text.find('}', charIndex) : std::string::npos;
+
+    // Outside a group, | and ] are ordinary characters
+    PatternToken token;
+    if (character == '[') {
+      token.type = PatternTokenType::GroupOpen;
+      token.targets.push_back(tokens.size() + 1);
+      openGroups.push_back(tokens.size());
+      alternativeEnds.emplace_back();
+    } else if (character == '|' && !openGroups.empty()) {
+      token.type = PatternTokenType::AlternativeEnd;
+      tokens[openGroups.back()].targets.push_back(tokens.size() + 1);
+      alternativeEnds.back().push_back(tokens.size());
+    } else if (character == ']' && !openGroups.empty()) {
+      token.type = PatternTokenType::GroupClose;
+      for (size_t alternativeEnd : alternativeEnds.back()) {
+        tokens[alternativeEnd].targets.push_back(tokens.size());
+      }
+      openGroups.pop_back();
+      alternativeEnds.pop_back();
+    } else if (character == '$') {
+      token.type = PatternTokenType::Capture;
+      token.capture.type = PatternElementType::Variable;
+    } else if (braceEnd != std::string::npos) {
+      token.type = PatternTokenType::Capture;
+      token.capture = parseCaptureElement(
+          text.substr(charIndex + 1, braceEnd - charIndex - 1));
+      charIndex = braceEnd;
+    } else {
+      token.character = character;
+    }
+    tokens.push_back(std::move(token));
+  }
+
+  // A [ that is never closed has no variants to walk
+  return openGroups.empty();
+}
+
+std::vector<std::string>
+PatternTree::requiredLiteralWords(const std::string &patternText) {
+  std::vector<std::string> words;
+
+  // Like parsePatternTokens(), give up on captures spanning a group boundary:
+  // which text ends up literal then differs between expansions
+  for (size_t open = patternText.find('{'); open != std::string::npos;
+       open = patternText.find('{', open + 1)) {
+    size_t close = patternText.find('}', open);
+    if (close != std::string::npos &&
+        patternText.find_first_of("[]|", open) < close) {
+      return words;
+    }
+  }
+
+  std::string currentWord;
+  auto flushWord = [&]() {
+    if (!currentWord.empty()) {
+      words.push_back(currentWord);
+      currentWord.clear();
+    }
+  };
+
+  // Only text outside [...] appears in every expansion. $ slots and {...}
+  // captures match arbitrary text, so they end a word like spaces do.
+  size_t bracketDepth = 0;
+  for (size_t charIndex = 0; charIndex < patternText.size(); charIndex++) {
+    char character = patternText[charIndex];
+    if (character == '[') {
+      flushWord();
+      bracketDepth++;
+    } else if (character == ']') {
+      flushWord();
+      if (bracketDepth > 0) {
+        bracketDepth--;
+      }
+    } else if (bracketDepth > 0) {
+      continue;
+    } else if (character == '{' &&
+               patternText.find('}', charIndex) != std::string::npos) {
+      flushWord();
+      charIndex = patternText.find('}', charIndex);
+    } else if (character == '$' || character == '{' || character == ' ' ||
+               character == '\t') {
+      flushWord();
+    } else {
+      currentWord += character;
+    }
+  }
+  flushWord();
+  return words;
+}
+
+// ============================================================================
+// Pattern Graph Implementation
+// ============================================================================
+
+void PatternTree::addPatternGraph(const std::vector<PatternToken> &tokens,
+                                  ResolvedPattern *pattern) {
+  PatternWalk walk;
+  walk.insert = true;
+  std::vector<uint32_t> endNodes = walkPattern(tokens, walk);
+  if (endNodes.empty())
+    return;
+
+  // Every node on the way can now reach this pattern
+  int specificity = pattern->specificity();
+  size_t order = patternOrder(pattern);
+  nodes[rootIndex].maxSpecificity =
+      std::max(nodes[rootIndex].maxSpecificity, specificity);
+  addPatternSlot(nodes[rootIndex].patternMask, order);
+  for (const auto &edge : walk.edges) {
+    nodes[edge.second].maxSpecificity =
+        std::max(nodes[edge.second].maxSpecificity, specificity);
+    addPatternSlot(nodes[edge.second].patternMask, order);
+  }
+
+  // Mark pattern as ending at each end node, ordered by insertion rank
+  for (uint32_t endNode : endNodes) {
+    auto &ended = nodes[endNode].patternsEndedHere;
+    if (std::find(ended.begin(), ended.end(), pattern) != ended.end())
+      continue;
+    auto position = std::upper_bound(
+        ended.begin(), ended.end(), order,
+        [this](size_t rank, const ResolvedPattern *other) {
+          return rank < patternOrder(other);
+        });
+    ended.insert(position, pattern);
+  }
+}
+
+void PatternTree::removePatternGraph(const std::vector<PatternToken> &tokens,
+                                     ResolvedPattern *pattern) {
+  PatternWalk walk;
+  for (uint32_t endNode : walkPattern(tokens, walk)) {
+    auto &ended = nodes[endNode].patternsEndedHere;
+    ended.erase(std::remove(ended.begin(), ended.end(), pattern), ended.end());
+  }
+
+  // Prune nodes that no longer lead anywhere. A node may hang below several
+  // of the walked edges, so repeat until nothing more is removed.
+  bool pruned = true;
+  while (pruned) {
+    pruned = false;
+    for (auto edge = walk.edges.rbegin(); edge != walk.edges.rend(); ++edge) {
+      if (nodes[edge->second].isEmpty() &&
+          unlinkChild(edge->first, edge->second)) {
+        pruned = true;
+      }
+    }
+  }
+
+  // Tighten the bounds of the walked nodes, deepest first
+  bool tightened = true;
+  while (tightened) {
+    tightened = false;
+    for (auto edge = walk.edges.rbegin(); edge != walk.edges.rend(); ++edge) {
+      for (uint32_t nodeIndex : {edge->second, edge->first}) {
+        tightened = refreshBounds(nodeIndex) || tightened;
+      }
+    }
+  }
+  refreshBounds(rootIndex);
+}
+
+std::vector<uint32_t>
+PatternTree::walkPattern(const std::vector<PatternToken> &tokens,
+                         PatternWalk &walk) {
+  std::vector<uint32_t> endNodes;
+  std::vector<PatternPathCursor> pending(1);
+  pending.front().node = rootIndex;
+
+  while (!pending.empty()) {
+    // Take every cursor at the lowest token position
+    auto lowest = std::min_element(
+        pending.begin(), pending.end(),
+        [](const PatternPathCursor &first, const PatternPathCursor &second) {
+          return first.position < second.position;
+        });
+    size_t position = lowest->position;
+    auto taken = std::stable_partition(
+        pending.begin(), pending.end(),
+        [position](const PatternPathCursor &cursor) {
+          return cursor.position != position;
+        });
+    std::vector<PatternPathCursor> current(
+        std::make_move_iterator(taken), std::make_move_iterator(pending.end()));
+    pending.erase(taken, pending.end());
+    std::vector<std::optional<PatternElement>> emitted;
+
+    if (position == tokens.size()) {
+      // Emit the literal still pending in each variant. A variant that is
+      // only spaces keeps them (expandPatternPaths() does not trim it
+      // either); an empty variant adds nothing.
+      std::vector<PatternPathCursor> finished;
+      for (const auto &cursor : current) {
+        if (cursor.atStart && cursor.leadingSpaces.empty())
+          continue;
+        const std::string &literal =
+            cursor.atStart ? cursor.leadingSpaces : cursor.literal;
+        emitted.push_back(literal.empty()
+                              ? std::nullopt
+                              : std::optional<PatternElement>(
+                                    literalElement(literal)));
+        finished.push_back(PatternPathCursor{cursor.node, position});
+        finished.back().atStart = false;
+      }
+      stepFrontier(finished, emitted, pending, walk);
+      for (const auto &cursor : finished) {
+        if (std::find(endNodes.begin(), endNodes.end(), cursor.node) ==
+            endNodes.end()) {
+          endNodes.push_back(cursor.node);
+        }
+      }
+      continue;
+    }
+
+    const PatternToken &token = tokens[position];
+    switch (token.type) {
+    case PatternTokenType::Character:
+      for (auto &cursor : current) {
+        appendCharacter(cursor, token.character);
+        cursor.position++;
+      }
+      break;
+
+    case PatternTokenType::GroupOpen: {
+      // Start a branch at every alternative
+      std::vector<PatternPathCursor> branches;
+      for (const auto &cursor : current) {
+        for (size_t target : token.targets) {
+          branches.push_back(cursor);
+          branches.back().position = target;
+        }
+      }
+      current = std::move(branches);
+      break;
+    }
+
+    case PatternTokenType::AlternativeEnd:
+      for (auto &cursor : current) {
+        cursor.position = token.targets.front();
+      }
+      break;
+
+    case PatternTokenType::GroupClose:
+      // Cut each branch's pending literal into an edge of its own, so
+      // branches that differ only in their literal text meet in one node
+      for (auto &cursor : current) {
+        cursor.position++;
+        if (cursor.literal.empty()) {
+          emitted.push_back(std::nullopt);
+          continue;
+        }
+        emitted.push_back(literalElement(cursor.literal));
+        cursor.literalOpen = true;
+        cursor.openLiteralSpace = cursor.literal.back() == ' ';
+        cursor.afterCapture = false;
+        cursor.literal.clear();
+      }
+      stepFrontier(current, emitted, pending, walk);
+      break;
+
+    case PatternTokenType::Capture:
+      // Flush the literal before the capture, with a trailing space. A
+      // literal already cut at a group end only needs the space itself.
+      for (auto &cursor : current) {
+        std::optional<PatternElement> flushed;
+        if (!cursor.literal.empty()) {
+          std::string literal = cursor.literal;
+          if (literal.back() != ' ') {
+            literal += " ";
+          }
+          flushed = literalElement(literal);
+        } else if (cursor.literalOpen && !cursor.openLiteralSpace) {
+          flushed = literalElement(" ");
+        }
+        emitted.push_back(flushed);
+        cursor = PatternPathCursor{cursor.node, position};
+        cursor.atStart = false;
+      }
+      stepFrontier(current, emitted, pending, walk);
+
+      emitted.assign(current.size(), token.capture);
+      for (auto &cursor : current) {
+        cursor.position++;
+        cursor.afterCapture = true;
+        cursor.skipSpace = true;
+      }
+      stepFrontier(current, emitted, pending, walk);
+      break;
+    }
+
+    for (const auto &cursor : current) {
+      queueCursor(pending, cursor);
+    }
+  }
+  return endNodes;
+}
+
+void PatternTree::stepFrontier(
+    std::vector<PatternPathCursor> &current,
+    std::vector<std::optional<PatternElement>> &emitted,
+    std::vector<PatternPathCursor> &pending, PatternWalk &walk) {
+  // An existing child can be continued from only if every edge into it
+  // belongs to the class stepping into it. Otherwise the class gets a copy;
+  // the paths moved to the copy are also paths of every cursor waiting at
+  // the child, so those cursors continue from the copy as well.
+  auto copySharedChild = [&]() {
+    for (const auto &members : groupCursors(current, emitted)) {
+      for (size_t member : members) {
+        if (!emitted[member])
+          continue;
+        uint32_t child = findChild(current[member].node, *emitted[member]);
+        if (child == PatternTreeNode::noNode)
+          continue;
+
+        std::vector<size_t> reaching;
+        for (size_t other : members) {
+          if (emitted[other] &&
+              findChild(current[other].node, *emitted[other]) == child) {
+            reaching.push_back(other);
+          }
+        }
+        if (reaching.size() == nodes[child].parentCount)
+          continue;
+
+        uint32_t copy = cloneNode(child);
+        for (size_t other : reaching) {
+          linkChild(current[other].node, *emitted[other], copy);
+        }
+        for (size_t index = 0, count = current.size(); index < count;
+             index++) {
+          if (current[index].node == child) {
+            current.push_back(current[index]);
+            current.back().node = copy;
+            emitted.push_back(emitted[index]);
+          }
+        }
+        for (size_t index = 0, count = pending.size(); index < count;
+             index++) {
+          if (pending[index].node == child) {
+            PatternPathCursor waiting = pending[index];
+            waiting.node = copy;
+            queueCursor(pending, waiting);
+          }
+        }
+        return true;
+      }
+    }
+    return false;
+  };
+  if (walk.insert) {
+    while (copySharedChild()) {
+    }
+  }
+
+  std::vector<PatternPathCursor> next;
+  for (const auto &members : groupCursors(current, emitted)) {
+    uint32_t sharedChild = PatternTreeNode::noNode;
+    for (size_t member : members) {
+      PatternPathCursor cursor = current[member];
+      if (emitted[member]) {
+        uint32_t child = findChild(cursor.node, *emitted[member]);
+        if (child == PatternTreeNode::noNode) {
+          if (!walk.insert)
+            continue;
+          // Children the class does not have yet become one new node
+          if (sharedChild == PatternTreeNode::noNode) {
+            sharedChild = allocateNode();
+          }
+          linkChild(cursor.node, *emitted[member], sharedChild);
+          child = sharedChild;
+        }
+        walk.edges.emplace_back(cursor.node, child);
+        cursor.node = child;
+      }
+      queueCursor(next, cursor);
+    }
+  }
+  current = std::move(next);
+}
+
+} // namespace tbx
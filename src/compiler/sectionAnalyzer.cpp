@@ -1,7 +1,13 @@
 #include "compiler/sectionAnalyzer.hpp"
+#include "compiler/sectionArena.hpp"
+#include "compiler/symbolTable.hpp"
 #include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <iostream>
+#include <set>
 #include <sstream>
+#include <thread>
 
 namespace tbx {
 
@@ -9,37 +15,37 @@ namespace tbx {
 // CodeLine Implementation
 // ============================================================================
 
-CodeLine::CodeLine(const std::string &lineText, int lineNum, std::string file,
+CodeLine::CodeLine(std::string_view lineText, int lineNum, uint32_t file,
                    int startCol, int endCol)
-    : text(lineText), lineNumber(lineNum), filePath(file),
-      startColumn(startCol), endColumn(endCol) {
+    : text(lineText), lineNumber(lineNum), fileSymbol(file),
+      startColumn(startCol), endColumn(endCol), words(splitLineWords(text)),
+      literals(detectLineLiterals(text)) {
 
-  std::string textToCheck = text;
+  std::string_view textToCheck = text;
 
   // Check for "private " prefix
-  if (textToCheck.size() >= 8 && textToCheck.substr(0, 8) == "private ") {
+  if (textToCheck.substr(0, 8) == "private ") {
     isPrivate = true;
-    textToCheck = textToCheck.substr(8);
+    textToCheck.remove_prefix(8);
   }
 
   // Pattern definitions start with "section ", "effect ", "expression ", or
   // "condition "
-  const std::vector<std::pair<std::string, PatternType>> patternPrefixes = {
+  static const std::pair<std::string_view, PatternType> patternPrefixes[] = {
       {"section ", PatternType::Section},
       {"effect ", PatternType::Effect},
       {"expression ", PatternType::Expression},
       {"condition ", PatternType::Expression}};
 
   // Also check for bare type keywords with just a colon (e.g., "expression:")
-  const std::vector<std::pair<std::string, PatternType>> bareKeywords = {
+  static const std::pair<std::string_view, PatternType> bareKeywords[] = {
       {"section:", PatternType::Section},
       {"effect:", PatternType::Effect},
       {"expression:", PatternType::Expression},
       {"condition:", PatternType::Expression}};
 
   for (const auto &[prefix, pType] : patternPrefixes) {
-    if (textToCheck.size() >= prefix.size() &&
-        textToCheck.substr(0, prefix.size()) == prefix) {
+    if (textToCheck.substr(0, prefix.size()) == prefix) {
       isPatternDefinition = true;
       type = pType;
       break;
@@ -58,6 +64,10 @@ CodeLine::CodeLine(const std::string &lineText, int lineNum, std::string file,
   }
 }
 
+const std::string &CodeLine::filePath() const {
+  return SymbolTable::global().name(fileSymbol);
+}
+
 std::string CodeLine::getPatternText() const {
   std::string result = text;
 
@@ -93,18 +103,68 @@ std::unique_ptr<CodeLine> CodeLine::clone() const {
   result->type = type;
   result->isResolved = isResolved;
   result->lineNumber = lineNumber;
-  result->filePath = filePath;
+  result->fileSymbol = fileSymbol;
   result->startColumn = startColumn;
   result->endColumn = endColumn;
-  // Note: childSection is NOT cloned as it's owned by the original
+  result->words = words;
+  result->literals = literals;
+  // Note: childSection is NOT cloned as it belongs to the original's tree, and
+  // parentSection stays null since the clone is not part of any section
   return result;
 }
 
+std::vector<LineWord> splitLineWords(std::string_view text) {
+  std::vector<LineWord> words;
+  SymbolTable &symbols = SymbolTable::global();
+  size_t pos = 0;
+  while (pos < text.size()) {
+    // Skip whitespace
+    while (pos < text.size() &&
+           std::isspace(static_cast<unsigned char>(text[pos]))) {
+      pos++;
+    }
+    if (pos >= text.size())
+      break;
+
+    size_t start = pos;
+    if (text[pos] == '"' || text[pos] == '\'') {
+      // Quoted string - capture until and including the closing quote
+      char quote = text[pos++];
+      while (pos < text.size() && text[pos] != quote) {
+        pos++;
+      }
+      if (pos < text.size()) {
+        pos++;
+      }
+    } else {
+      // Regular word - capture until whitespace
+      while (pos < text.size() &&
+             !std::isspace(static_cast<unsigned char>(text[pos]))) {
+        pos++;
+      }
+    }
+
+    LineWord word;
+    word.start = static_cast<uint32_t>(start);
+    word.length = static_cast<uint32_t>(pos - start);
+    word.symbol = symbols.intern(text.substr(start, pos - start));
+    words.push_back(word);
+  }
+  return words;
+}
+
 // ============================================================================
 // Section Implementation
 // ============================================================================
 
-void Section::addLine(CodeLine line) { lines.push_back(std::move(line)); }
+void Section::addLine(CodeLine line) {
+  line.parentSection = this;
+  if (line.childSection) {
+    line.childSection->parent = this;
+    line.childSection->parentLineIndex = lines.size();
+  }
+  lines.push_back(std::move(line));
+}
 
 bool Section::allLinesResolved() const {
   for (const auto &line : lines) {
@@ -115,6 +175,23 @@ bool Section::allLinesResolved() const {
   return true;
 }
 
+void Section::cloneLinesInto(Section &target, SectionArena &arena) const {
+  target.lines.reserve(target.lines.size() + lines.size());
+  for (const auto &line : lines) {
+    std::unique_ptr<CodeLine> copy = line.clone();
+    if (line.childSection) {
+      // Created before the copies of its own child sections, in pre-order
+      Section *childCopy = arena.create();
+      childCopy->isResolved = line.childSection->isResolved;
+      childCopy->resolvedVariables = line.childSection->resolvedVariables;
+      childCopy->indentLevel = line.childSection->indentLevel;
+      line.childSection->cloneLinesInto(*childCopy, arena);
+      copy->childSection = childCopy;
+    }
+    target.addLine(std::move(*copy));
+  }
+}
+
 void Section::print(int depth) const {
   std::string indent(depth * 2, ' ');
 
@@ -144,22 +221,16 @@ void Section::print(int depth) const {
 // SectionAnalyzer Implementation
 // ============================================================================
 
-std::string SectionAnalyzer::trim(const std::string &str) {
-  size_t start = 0;
-  while (start < str.size() && (str[start] == ' ' || str[start] == '\t')) {
-    start++;
+std::string_view SectionAnalyzer::trim(std::string_view str) {
+  size_t start = str.find_first_not_of(" \t");
+  if (start == std::string_view::npos) {
+    return {};
   }
 
-  if (start == str.size()) {
-    return "";
-  }
-
-  size_t end = str.size();
-
   // Find if there is a comment in the line and strip it
-  size_t commentPos = str.find('#');
-  if (commentPos != std::string::npos) {
-    end = commentPos;
+  size_t end = str.find('#');
+  if (end == std::string_view::npos) {
+    end = str.size();
   }
 
   while (end > start && (str[end - 1] == ' ' || str[end - 1] == '\t' ||
@@ -168,93 +239,81 @@ std::string SectionAnalyzer::trim(const std::string &str) {
   }
 
   if (end <= start)
-    return "";
+    return {};
 
   return str.substr(start, end - start);
 }
 
-int SectionAnalyzer::calculateIndent(const std::string &line, int &startCol) {
-  int indent = 0;
-  startCol = 0;
-  for (char c : line) {
-    if (c == ' ') {
-      indent++;
-      startCol++;
-    } else if (c == '\t') {
-      // Treat tabs as 4 spaces
-      indent += 4;
-      startCol++;
-    } else {
-      break;
-    }
+int SectionAnalyzer::calculateIndent(std::string_view line, int &startCol) {
+  size_t indentEnd = line.find_first_not_of(" \t");
+  if (indentEnd == std::string_view::npos) {
+    indentEnd = line.size();
   }
-  return indent;
-}
-
-bool SectionAnalyzer::isComment(const std::string &line) {
-  std::string trimmedText = trim(line);
-  return !trimmedText.empty() && trimmedText[0] == '#';
+  // Tabs count as 4 spaces
+  auto tabCount = std::count(line.begin(), line.begin() + indentEnd, '\t');
+  startCol = static_cast<int>(indentEnd);
+  return static_cast<int>(indentEnd + 3 * tabCount);
 }
 
-bool SectionAnalyzer::isPatternDefinition(const std::string &line) {
-  std::string textToCheck = line;
-  if (textToCheck.size() >= 8 && textToCheck.substr(0, 8) == "private ") {
-    textToCheck = textToCheck.substr(8);
+bool SectionAnalyzer::isPatternDefinition(std::string_view line) {
+  std::string_view textToCheck = line;
+  if (textToCheck.substr(0, 8) == "private ") {
+    textToCheck.remove_prefix(8);
   }
 
-  const std::vector<std::string> patternPrefixes = {
+  static const std::string_view patternPrefixes[] = {
       "section ", "effect ", "expression ", "condition "};
 
-  for (const auto &prefix : patternPrefixes) {
-    if (textToCheck.size() >= prefix.size() &&
-        textToCheck.substr(0, prefix.size()) == prefix) {
+  for (std::string_view prefix : patternPrefixes) {
+    if (textToCheck.substr(0, prefix.size()) == prefix) {
       return true;
     }
   }
   return false;
 }
 
-bool SectionAnalyzer::endsWithColon(const std::string &line) {
-  std::string trimmedText = trim(line);
-  return !trimmedText.empty() && trimmedText.back() == ':';
+bool SectionAnalyzer::endsWithColon(std::string_view text) {
+  return !text.empty() && text.back() == ':';
 }
 
 std::vector<SectionAnalyzer::SourceLine>
-SectionAnalyzer::splitLines(const std::string &source,
-                            const std::map<int, SourceLocation> &sourceMap) {
+SectionAnalyzer::splitLines(const std::vector<std::string_view> &source,
+                            const std::vector<SourceMapEntry> &sourceMap,
+                            size_t begin, size_t end) {
   std::vector<SourceLine> lines;
-  std::istringstream stream(source);
-  std::string line;
-  int currentLineNumber = 0;
+  lines.reserve(end - begin);
+  int currentLineNumber = static_cast<int>(begin);
 
-  while (std::getline(stream, line)) {
+  for (size_t lineIndex = begin; lineIndex < end; lineIndex++) {
     currentLineNumber++;
+    std::string_view line = source[lineIndex];
 
     SourceLine sl;
     sl.lineNumber = currentLineNumber;
     int startCol = 0;
     sl.indentLevel = calculateIndent(line, startCol);
+    // trim() drops comments, so a comment-only line has no text left
     sl.text = trim(line);
-    sl.isEmpty = sl.text.empty() || isComment(sl.text);
+    sl.isEmpty = sl.text.empty();
 
     if (!sl.isEmpty) {
       sl.startColumn = startCol;
       // Calculate where the text ends in the line, but before comments if any.
       // sl.text is already trimmed (no leading spaces, no comments, no trailing
       // whitespace)
-      sl.endColumn = startCol + sl.text.length();
+      sl.endColumn = startCol + static_cast<int>(sl.text.length());
     } else {
       sl.startColumn = 0;
       sl.endColumn = 0;
     }
 
     // Look up original source location
-    auto it = sourceMap.find(currentLineNumber);
-    if (it != sourceMap.end()) {
-      sl.filePath = it->second.filePath;
-      sl.originalLine = it->second.lineNumber;
+    size_t mapIndex = static_cast<size_t>(currentLineNumber - 1);
+    if (mapIndex < sourceMap.size() && sourceMap[mapIndex].fileSymbol != 0) {
+      sl.fileSymbol = sourceMap[mapIndex].fileSymbol;
+      sl.originalLine = static_cast<int>(sourceMap[mapIndex].lineNumber);
     } else {
-      sl.filePath = "";
+      sl.fileSymbol = 0;
       sl.originalLine = currentLineNumber;
     }
 
@@ -266,7 +325,8 @@ SectionAnalyzer::splitLines(const std::string &source,
 
 void SectionAnalyzer::buildSection(Section &section,
                                    const std::vector<SourceLine> &lines,
-                                   size_t &index, int parentIndent) {
+                                   size_t &index, int parentIndent,
+                                   SectionArena &arena) {
   // Track the indent level of this section (set when we see the first line)
   int sectionIndent = -1;
 
@@ -298,7 +358,7 @@ void SectionAnalyzer::buildSection(Section &section,
           "Inconsistent indentation: expected indent " +
               std::to_string(sectionIndent) + " but got " +
               std::to_string(line.indentLevel),
-          line.filePath, line.originalLine);
+          SymbolTable::global().name(line.fileSymbol), line.originalLine);
       // Try to recover by treating it as end of section
       return;
     }
@@ -311,17 +371,19 @@ void SectionAnalyzer::buildSection(Section &section,
       if (!section.lines.empty()) {
         CodeLine &prevLine = section.lines.back();
         if (!prevLine.childSection) {
-          prevLine.childSection = std::make_unique<Section>();
+          prevLine.childSection = arena.create();
           prevLine.childSection->parent = &section;
+          prevLine.childSection->parentLineIndex = section.lines.size() - 1;
         }
-        buildSection(*prevLine.childSection, lines, index, sectionIndent);
+        buildSection(*prevLine.childSection, lines, index, sectionIndent,
+                     arena);
         continue;
       }
     }
 
     // This line is at the section's indent level - it's a sibling line
     // Create code line for this source line
-    CodeLine codeLine(line.text, line.originalLine, line.filePath,
+    CodeLine codeLine(line.text, line.originalLine, line.fileSymbol,
                       line.startColumn, line.endColumn);
 
     // Check if this line ends with ":" - it will have a child section
@@ -340,7 +402,7 @@ void SectionAnalyzer::buildSection(Section &section,
       // If next line has greater indent, it's a child section
       if (nextIndex < lines.size() &&
           lines[nextIndex].indentLevel > line.indentLevel) {
-        codeLine.childSection = std::make_unique<Section>();
+        codeLine.childSection = arena.create();
         codeLine.childSection->parent = &section;
 
         // Adjust endColumn to exclude the trailing colon for the pattern itself
@@ -354,7 +416,8 @@ void SectionAnalyzer::buildSection(Section &section,
         index = nextIndex;
 
         // Build the child section
-        buildSection(*codeLine.childSection, lines, index, line.indentLevel);
+        buildSection(*codeLine.childSection, lines, index, line.indentLevel,
+                     arena);
       }
     }
 
@@ -362,23 +425,162 @@ void SectionAnalyzer::buildSection(Section &section,
   }
 }
 
-std::unique_ptr<Section>
-SectionAnalyzer::analyze(const std::string &source,
-                         const std::map<int, SourceLocation> &sourceMap) {
+SectionSubtree
+SectionAnalyzer::analyzeRun(const std::vector<std::string_view> &source,
+                            const std::vector<SourceMapEntry> &sourceMap,
+                            size_t begin, size_t end, bool keepLines) {
+  SectionAnalyzer runAnalyzer;
+  std::vector<SourceLine> lines =
+      runAnalyzer.splitLines(source, sourceMap, begin, end);
+
+  SectionSubtree subtree;
+  size_t index = 0;
+  runAnalyzer.buildSection(*subtree.sections.root(), lines, index, -1,
+                           subtree.sections);
+
+  // Splicing matches merged analysis when the run closes every section of
+  // the runs before it and reports no error that would stop the analysis
+  auto firstLine = std::find_if(lines.begin(), lines.end(),
+                                [](const SourceLine &line) {
+                                  return !line.isEmpty;
+                                });
+  subtree.spliceable =
+      runAnalyzer.diagnosticsData.empty() &&
+      (firstLine == lines.end() || firstLine->indentLevel == 0);
+
+  if (keepLines) {
+    subtree.lines.assign(source.begin() + begin, source.begin() + end);
+  }
+  return subtree;
+}
+
+bool SectionAnalyzer::analyzeFiles(
+    SectionArena &arena, const std::vector<std::string_view> &source,
+    const std::vector<SourceMapEntry> &sourceMap) {
+  if (sourceMap.size() < source.size()) {
+    return false;
+  }
+
+  // A run ends where the file or the line numbering changes. Generated lines
+  // (the import markers) are comments and belong to no run.
+  std::vector<std::pair<size_t, size_t>> runs;
+  size_t lineIndex = 0;
+  while (lineIndex < source.size()) {
+    if (sourceMap[lineIndex].fileSymbol == 0) {
+      lineIndex++;
+      continue;
+    }
+    size_t begin = lineIndex++;
+    while (lineIndex < source.size() &&
+           sourceMap[lineIndex].fileSymbol == sourceMap[begin].fileSymbol &&
+           sourceMap[lineIndex].lineNumber ==
+               sourceMap[lineIndex - 1].lineNumber + 1) {
+      lineIndex++;
+    }
+    runs.emplace_back(begin, lineIndex);
+  }
+
+  std::vector<const SectionSubtree *> subtrees(runs.size(), nullptr);
+  std::vector<size_t> missing;
+  for (size_t runIndex = 0; runIndex < runs.size(); runIndex++) {
+    const auto &[begin, end] = runs[runIndex];
+    if (subtreeCache) {
+      subtrees[runIndex] = subtreeCache->find(
+          sourceMap[begin].fileSymbol, sourceMap[begin].lineNumber, source,
+          begin, end);
+    }
+    if (!subtrees[runIndex]) {
+      missing.push_back(runIndex);
+    }
+  }
+
+  // Runs share no state besides the thread-safe symbol table
+  std::vector<SectionSubtree> built(missing.size());
+  size_t threadCount = std::min<size_t>(jobCount, missing.size());
+  std::atomic<size_t> nextIndex{0};
+  auto worker = [&]() {
+    for (size_t index = nextIndex++; index < missing.size();
+         index = nextIndex++) {
+      const auto &[begin, end] = runs[missing[index]];
+      built[index] = analyzeRun(source, sourceMap, begin, end,
+                                subtreeCache != nullptr);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t threadIndex = 1; threadIndex < threadCount; threadIndex++) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : workers) {
+    thread.join();
+  }
+  for (size_t index = 0; index < missing.size(); index++) {
+    subtrees[missing[index]] = &built[index];
+  }
+
+  bool spliceable = true;
+  for (const SectionSubtree *subtree : subtrees) {
+    spliceable = spliceable && subtree->spliceable;
+  }
+
+  if (spliceable) {
+    // Without a cache every subtree was just built and can be moved; cached
+    // subtrees stay untouched for the next analysis
+    Section &root = *arena.root();
+    for (size_t runIndex = 0; runIndex < runs.size(); runIndex++) {
+      if (subtreeCache) {
+        subtrees[runIndex]->sections.root()->cloneLinesInto(root, arena);
+        continue;
+      }
+      SectionArena &runSections = built[runIndex].sections;
+      for (auto &line : runSections.root()->lines) {
+        root.addLine(std::move(line));
+      }
+      arena.adopt(std::move(runSections));
+    }
+    if (!root.lines.empty()) {
+      root.indentLevel = 0;
+    }
+  }
+
+  if (subtreeCache) {
+    for (size_t index = 0; index < missing.size(); index++) {
+      const auto &[begin, end] = runs[missing[index]];
+      subtreeCache->store(sourceMap[begin].fileSymbol,
+                          sourceMap[begin].lineNumber,
+                          std::move(built[index]));
+    }
+    std::set<std::pair<uint32_t, uint32_t>> usedRuns;
+    for (const auto &[begin, end] : runs) {
+      usedRuns.insert(
+          {sourceMap[begin].fileSymbol, sourceMap[begin].lineNumber});
+    }
+    subtreeCache->retain(usedRuns);
+  }
+  return spliceable;
+}
+
+SectionArena
+SectionAnalyzer::analyze(const std::vector<std::string_view> &source,
+                         const std::vector<SourceMapEntry> &sourceMap) {
   diagnosticsData.clear();
 
-  // Split source into lines with indent information
-  std::vector<SourceLine> lines = splitLines(source, sourceMap);
+  // The arena starts with the root section at "virtual" indent -1
+  SectionArena arena;
+
+  if (!sourceMap.empty() && analyzeFiles(arena, source, sourceMap)) {
+    return arena;
+  }
 
-  // Create root section
-  auto root = std::make_unique<Section>();
-  root->indentLevel = -1; // Root is at "virtual" indent -1
+  // Split source into lines with indent information
+  std::vector<SourceLine> lines =
+      splitLines(source, sourceMap, 0, source.size());
 
   // Build the section tree
   size_t index = 0;
-  buildSection(*root, lines, index, -1);
+  buildSection(*arena.root(), lines, index, -1, arena);
 
-  return root;
+  return arena;
 }
 
 } // namespace tbx
@@ -0,0 +1,52 @@
+#include "compiler/sectionArena.hpp"
+
+namespace tbx {
+
+// ============================================================================
+// SectionArena Implementation
+// ============================================================================
+
+SectionArena::SectionArena() {
+  Section *rootSection = create();
+  rootSection->indentLevel = -1; // Root is at "virtual" indent -1
+}
+
+Section *SectionArena::create() {
+  if (blocks.empty() || usedInBlock == blockSize) {
+    blocks.push_back(std::make_unique<Section[]>(blockSize));
+    usedInBlock = 0;
+  }
+  Section *section = &blocks.back()[usedInBlock++];
+  section->index = static_cast<uint32_t>(sectionList.size());
+  sectionList.push_back(section);
+  return section;
+}
+
+void SectionArena::adopt(SectionArena &&other) {
+  for (size_t sectionIndex = 1; sectionIndex < other.sectionList.size();
+       sectionIndex++) {
+    Section *section = other.sectionList[sectionIndex];
+    section->index = static_cast<uint32_t>(sectionList.size());
+    sectionList.push_back(section);
+  }
+
+  // Keep filling the last block of this arena; the adopted blocks are only
+  // kept alive
+  std::unique_ptr<Section[]> currentBlock;
+  if (!blocks.empty()) {
+    currentBlock = std::move(blocks.back());
+    blocks.pop_back();
+  }
+  for (auto &block : other.blocks) {
+    blocks.push_back(std::move(block));
+  }
+  if (currentBlock) {
+    blocks.push_back(std::move(currentBlock));
+  }
+
+  other.blocks.clear();
+  other.sectionList.clear();
+  other.usedInBlock = 0;
+}
+
+} // namespace tbx
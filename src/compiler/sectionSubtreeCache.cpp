@@ -0,0 +1,43 @@
+#include "compiler/sectionSubtreeCache.hpp"
+
+#include <algorithm>
+
+namespace tbx {
+
+// ============================================================================
+// SectionSubtreeCache Implementation
+// ============================================================================
+
+const SectionSubtree *
+SectionSubtreeCache::find(uint32_t fileSymbol, uint32_t firstLine,
+                          const std::vector<std::string_view> &source,
+                          size_t begin, size_t end) const {
+  auto entry = subtrees.find({fileSymbol, firstLine});
+  if (entry == subtrees.end()) {
+    return nullptr;
+  }
+  const std::vector<std::string> &lines = entry->second.lines;
+  if (lines.size() != end - begin ||
+      !std::equal(lines.begin(), lines.end(), source.begin() + begin)) {
+    return nullptr;
+  }
+  return &entry->second;
+}
+
+void SectionSubtreeCache::store(uint32_t fileSymbol, uint32_t firstLine,
+                                SectionSubtree subtree) {
+  subtrees[{fileSymbol, firstLine}] = std::move(subtree);
+}
+
+void SectionSubtreeCache::retain(
+    const std::set<std::pair<uint32_t, uint32_t>> &runs) {
+  for (auto entry = subtrees.begin(); entry != subtrees.end();) {
+    if (!runs.count(entry->first)) {
+      entry = subtrees.erase(entry);
+    } else {
+      ++entry;
+    }
+  }
+}
+
+} // namespace tbx
@@ -0,0 +1,56 @@
+#include "compiler/symbolTable.hpp"
+
+#include <cctype>
+
+namespace tbx {
+
+// ============================================================================
+// SymbolTable Implementation
+// ============================================================================
+
+SymbolTable::SymbolTable() { intern(""); }
+
+SymbolTable &SymbolTable::global() {
+  static SymbolTable table;
+  return table;
+}
+
+uint32_t SymbolTable::intern(std::string_view text) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto existing = symbols.find(text);
+  if (existing != symbols.end()) {
+    return existing->second;
+  }
+
+  uint32_t symbol = static_cast<uint32_t>(names.size());
+  names.emplace_back(text);
+  symbols.emplace(names.back(), symbol);
+  return symbol;
+}
+
+const std::string &SymbolTable::name(uint32_t symbol) const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return names[symbol];
+}
+
+std::vector<uint32_t> SymbolTable::internWords(std::string_view text) {
+  std::vector<uint32_t> words;
+  size_t pos = 0;
+  while (pos < text.size()) {
+    while (pos < text.size() &&
+           std::isspace(static_cast<unsigned char>(text[pos]))) {
+      pos++;
+    }
+    size_t start = pos;
+    while (pos < text.size() &&
+           !std::isspace(static_cast<unsigned char>(text[pos]))) {
+      pos++;
+    }
+    if (pos > start) {
+      words.push_back(intern(text.substr(start, pos - start)));
+    }
+  }
+  return words;
+}
+
+} // namespace tbx
@@ -0,0 +1,110 @@
+#include "compiler/typeConstraintGraph.hpp"
+
+namespace tbx {
+
+// ============================================================================
+// TypeConstraintGraph Implementation
+// ============================================================================
+
+size_t TypeConstraintGraph::addNode() {
+  parents.push_back(parents.size());
+  ranks.push_back(0);
+  return parents.size() - 1;
+}
+
+size_t TypeConstraintGraph::find(size_t node) {
+  // Path halving keeps the trees flat without recursion
+  while (parents[node] != node) {
+    parents[node] = parents[parents[node]];
+    node = parents[node];
+  }
+  return node;
+}
+
+void TypeConstraintGraph::unite(size_t first, size_t second) {
+  size_t firstRoot = find(first);
+  size_t secondRoot = find(second);
+  if (firstRoot == secondRoot) {
+    return;
+  }
+  if (ranks[firstRoot] < ranks[secondRoot]) {
+    std::swap(firstRoot, secondRoot);
+  }
+  parents[secondRoot] = firstRoot;
+  if (ranks[firstRoot] == ranks[secondRoot]) {
+    ranks[firstRoot]++;
+  }
+}
+
+void TypeConstraintGraph::require(size_t node, InferredType type) {
+  requirements.emplace_back(node, type);
+}
+
+void TypeConstraintGraph::observe(size_t node, InferredType type) {
+  observations.emplace_back(node, type);
+}
+
+InferredType TypeConstraintGraph::join(InferredType first,
+                                       InferredType second) {
+  if (first == second) {
+    return first;
+  }
+  if ((first == InferredType::I64 && second == InferredType::F64) ||
+      (first == InferredType::F64 && second == InferredType::I64)) {
+    return InferredType::F64;
+  }
+  return InferredType::Unknown;
+}
+
+void TypeConstraintGraph::solve() {
+  requiredTypes.assign(parents.size(), InferredType::Unknown);
+  observedTypes.assign(parents.size(), InferredType::Unknown);
+  requiredConflicts.assign(parents.size(), 0);
+  observedConflicts.assign(parents.size(), 0);
+  unknownValues.assign(parents.size(), 0);
+
+  auto merge = [](InferredType &current, char &conflict, InferredType type) {
+    if (current == InferredType::Unknown) {
+      current = type;
+    } else {
+      InferredType joined = join(current, type);
+      if (joined == InferredType::Unknown) {
+        conflict = 1;
+      } else {
+        current = joined;
+      }
+    }
+  };
+
+  for (const auto &[node, type] : requirements) {
+    size_t root = find(node);
+    merge(requiredTypes[root], requiredConflicts[root], type);
+  }
+  for (const auto &[node, type] : observations) {
+    size_t root = find(node);
+    if (type == InferredType::Unknown) {
+      unknownValues[root] = 1;
+    } else {
+      merge(observedTypes[root], observedConflicts[root], type);
+    }
+  }
+}
+
+InferredType TypeConstraintGraph::solution(size_t node) {
+  size_t root = find(node);
+  InferredType required = requiredTypes[root];
+  InferredType observed = observedTypes[root];
+  if (requiredConflicts[root] || observedConflicts[root]) {
+    return InferredType::Unknown;
+  }
+
+  // A value of unknown type does not contradict what the intrinsics need
+  if (required != InferredType::Unknown) {
+    bool contradicted = observed != InferredType::Unknown &&
+                        join(required, observed) != required;
+    return contradicted ? InferredType::Unknown : required;
+  }
+  return unknownValues[root] ? InferredType::Unknown : observed;
+}
+
+} // namespace tbx
@@ -292,7 +292,10 @@ bool TypeInference::infer(const SectionPatternResolver &resolver) {
     }
   }
 
-  // Phase 2: Infer types for all pattern calls
+  // Phase 2: Propagate parameter types between calls and definitions
+  solveCallConstraints(resolver);
+
+  // Phase 3: Infer types for all pattern calls
   for (const auto &match : resolver.patternMatches()) {
     auto typed = inferCallTypes(match.get());
     if (typed) {
@@ -305,7 +308,7 @@ bool TypeInference::infer(const SectionPatternResolver &resolver) {
     for (const auto &[name, type] : typedPattern->parameterTypes) {
       if (type == InferredType::Unknown) {
         // Get pattern definition location
-        std::string filePath = typedPattern->pattern->sourceLine->filePath;
+        std::string filePath = typedPattern->pattern->sourceLine->filePath();
         int lineNum = typedPattern->pattern->sourceLine->lineNumber;
 
         diagnosticsData.emplace_back(
@@ -317,7 +320,7 @@ bool TypeInference::infer(const SectionPatternResolver &resolver) {
     if (typedPattern->returnType == InferredType::Unknown &&
         typedPattern->pattern->type == PatternType::Expression) {
       // Get pattern definition location
-      std::string filePath = typedPattern->pattern->sourceLine->filePath;
+      std::string filePath = typedPattern->pattern->sourceLine->filePath();
       int lineNum = typedPattern->pattern->sourceLine->lineNumber;
 
       diagnosticsData.emplace_back(
@@ -354,7 +357,7 @@ TypeInference::inferPatternTypes(ResolvedPattern *pattern) {
   // Analyze the body section for intrinsic calls
   if (pattern->body) {
     for (const auto &line : pattern->body->lines) {
-      auto intrinsics = parseIntrinsics(line.text);
+      auto intrinsics = parseIntrinsics(line);
 
       for (const auto &intrinsic : intrinsics) {
         typed->bodyIntrinsics.push_back(intrinsic.name);
@@ -380,7 +383,7 @@ TypeInference::inferPatternTypes(ResolvedPattern *pattern) {
                 InferredType unified = unifyTypes(it->second, expectedType);
                 if (unified == InferredType::Unknown) {
                   // Get location from pattern definition
-                  std::string filePath = pattern->sourceLine->filePath;
+                  std::string filePath = pattern->sourceLine->filePath();
                   int lineNum = pattern->sourceLine->lineNumber;
 
                   diagnosticsData.emplace_back(
@@ -409,7 +412,7 @@ TypeInference::inferPatternTypes(ResolvedPattern *pattern) {
               InferredType unified = unifyTypes(typed->returnType, retType);
               if (unified == InferredType::Unknown) {
                 // Get location from pattern definition
-                std::string filePath = pattern->sourceLine->filePath;
+                std::string filePath = pattern->sourceLine->filePath();
                 int lineNum = pattern->sourceLine->lineNumber;
 
                 diagnosticsData.emplace_back(
@@ -428,7 +431,7 @@ TypeInference::inferPatternTypes(ResolvedPattern *pattern) {
       // Also check child sections (for nested "execute:", "get:", etc.)
       if (line.childSection) {
         for (const auto &childLine : line.childSection->lines) {
-          auto childIntrinsics = parseIntrinsics(childLine.text);
+          auto childIntrinsics = parseIntrinsics(childLine);
 
           for (const auto &intrinsic : childIntrinsics) {
             typed->bodyIntrinsics.push_back(intrinsic.name);
@@ -510,7 +513,7 @@ std::unique_ptr<TypedCall> TypeInference::inferCallTypes(PatternMatch *match) {
                  expected != InferredType::Unknown) {
           if (!isCompatible(expected, tv.type)) {
             // Get location from match
-            std::string filePath = match->pattern->sourceLine->filePath;
+            std::string filePath = match->pattern->sourceLine->filePath();
             int lineNum = match->pattern->sourceLine->lineNumber;
 
             // Try to find the specific line of the call if possible
@@ -538,17 +541,64 @@ std::unique_ptr<TypedCall> TypeInference::inferCallTypes(PatternMatch *match) {
   return typed;
 }
 
-std::vector<IntrinsicInfo>
-TypeInference::parseIntrinsics(const std::string &text) {
-  std::vector<IntrinsicInfo> result;
+// Normalize a cached intrinsic argument: whitespace outside quotes is dropped
+// and surrounding quotes are removed
+static std::string intrinsicArgument(const std::string &argument) {
+  std::string result;
+  bool inString = false;
+  char stringChar = '\0';
+  for (char character : argument) {
+    if (inString) {
+      result += character;
+      if (character == stringChar) {
+        inString = false;
+      }
+    } else if (character == '"' || character == '\'') {
+      inString = true;
+      stringChar = character;
+      result += character;
+    } else if (character != ' ' && character != '\t') {
+      result += character;
+    }
+  }
+
+  if (result.size() >= 2 && (result.front() == '"' || result.front() == '\'') &&
+      result.back() == result.front()) {
+    result = result.substr(1, result.size() - 2);
+  }
+  return result;
+}
+
+// Add the @intrinsic(...) calls among the literals of text to result, left to
+// right, including the calls nested in the arguments of a call or in a group
+static void collectIntrinsics(std::string_view text,
+                              const std::vector<LineLiteral> &literals,
+                              std::vector<IntrinsicInfo> &result) {
+  for (const LineLiteral &literal : literals) {
+    if (literal.type == LineLiteralType::Group) {
+      // The inner literals keep their offsets into text, so a call right
+      // after "return(" still counts as returned
+      std::string_view group = literal.view(text);
+      if (group.find('@') == std::string_view::npos) {
+        continue;
+      }
+      std::vector<LineLiteral> inner =
+          detectLineLiterals(group.substr(1, group.size() - 1));
+      for (LineLiteral &innerLiteral : inner) {
+        innerLiteral.start += literal.start + 1;
+      }
+      collectIntrinsics(text, inner, result);
+      continue;
+    }
+    if (literal.type != LineLiteralType::Intrinsic ||
+        literal.intrinsicName != "intrinsic")
+      continue;
 
-  // Find all @intrinsic calls in the text
-  size_t pos = 0;
-  while ((pos = text.find("@intrinsic(", pos)) != std::string::npos) {
     // Check if preceded by "return"
+    size_t pos = literal.start;
     bool hasReturn = false;
     if (pos >= 7) {
-      std::string prefix = text.substr(pos - 7, 7);
+      std::string prefix(text.substr(pos - 7, 7));
       // Trim leading whitespace
       size_t start = prefix.find_first_not_of(" \t");
       if (start != std::string::npos) {
@@ -559,102 +609,39 @@ TypeInference::parseIntrinsics(const std::string &text) {
       }
     }
 
-    IntrinsicInfo info = parseSingleIntrinsic(text, pos);
+    // The first argument is the intrinsic name as a string
+    IntrinsicInfo info;
+    const auto &args = literal.intrinsicArgs;
+    if (!args.empty() && args[0].size() >= 2 && args[0].front() == '"' &&
+        args[0].back() == '"') {
+      info.name = args[0].substr(1, args[0].size() - 2);
+      for (size_t argIndex = 1; argIndex < args.size(); argIndex++) {
+        std::string argument = intrinsicArgument(args[argIndex]);
+        if (!argument.empty()) {
+          info.arguments.push_back(std::move(argument));
+        }
+      }
+    }
     info.hasReturn = hasReturn;
     result.push_back(info);
 
-    pos++; // Move past current position to find next
-  }
-
-  return result;
-}
-
-IntrinsicInfo TypeInference::parseSingleIntrinsic(const std::string &text,
-                                                  size_t startPos) {
-  IntrinsicInfo info;
-
-  // Skip "@intrinsic("
-  size_t pos = startPos + 11; // Length of "@intrinsic("
-
-  // Find the closing parenthesis, accounting for nested parens
-  int parenDepth = 1;
-  size_t endPos = pos;
-  while (endPos < text.size() && parenDepth > 0) {
-    if (text[endPos] == '(')
-      parenDepth++;
-    else if (text[endPos] == ')')
-      parenDepth--;
-    endPos++;
-  }
-  endPos--; // Back to the closing paren
-
-  // Extract the content between parentheses
-  std::string content = text.substr(pos, endPos - pos);
-
-  // Parse the intrinsic name (first argument, should be a string)
-  size_t nameStart = content.find('"');
-  if (nameStart != std::string::npos) {
-    size_t nameEnd = content.find('"', nameStart + 1);
-    if (nameEnd != std::string::npos) {
-      info.name = content.substr(nameStart + 1, nameEnd - nameStart - 1);
-
-      // Parse the remaining arguments
-      pos = nameEnd + 1;
-
-      // Skip to comma or end
-      while (pos < content.size()) {
-        // Skip whitespace and commas
-        while (pos < content.size() &&
-               (content[pos] == ' ' || content[pos] == ',' ||
-                content[pos] == '\t')) {
-          pos++;
-        }
-
-        if (pos >= content.size())
-          break;
-
-        // Read the argument
-        std::string arg;
-        bool inString = false;
-        char stringChar = '\0';
-
-        while (pos < content.size()) {
-          char character = content[pos];
-
-          if (inString) {
-            arg += character;
-            if (character == stringChar) {
-              inString = false;
-            }
-            pos++;
-          } else if (character == '"' || character == '\'') {
-            inString = true;
-            stringChar = character;
-            arg += character;
-            pos++;
-          } else if (character == ',' || character == ')') {
-            break;
-          } else if (character == ' ' || character == '\t') {
-            pos++;
-          } else {
-            arg += character;
-            pos++;
-          }
-        }
-
-        if (!arg.empty()) {
-          // Remove surrounding quotes if present
-          if (arg.size() >= 2 && (arg.front() == '"' || arg.front() == '\'') &&
-              arg.back() == arg.front()) {
-            arg = arg.substr(1, arg.size() - 2);
-          }
-          info.arguments.push_back(arg);
-        }
+    // Calls nested in an argument come after the call that contains them
+    for (const std::string &arg : args) {
+      if (arg.find('@') != std::string::npos) {
+        collectIntrinsics(arg, detectLineLiterals(arg), result);
       }
     }
   }
+}
 
-  return info;
+std::vector<IntrinsicInfo>
+TypeInference::parseIntrinsics(const CodeLine &line) {
+  std::vector<IntrinsicInfo> result;
+
+  // The top-level literals and their arguments were found when the line was
+  // created; only calls nested inside them are detected here
+  collectIntrinsics(line.text, line.literals, result);
+  return result;
 }
 
 InferredType TypeInference::inferValueType(const ResolvedValue &value) {
@@ -0,0 +1,103 @@
+#include "compiler/typeConstraintGraph.hpp"
+#include "compiler/typeInference.hpp"
+
+#include <utility>
+
+namespace tbx {
+
+// Collect the lines of a section and of its child sections
+static void collectBodyLines(Section *section, std::vector<CodeLine *> &lines) {
+  for (auto &line : section->lines) {
+    lines.push_back(&line);
+    if (line.childSection) {
+      collectBodyLines(line.childSection, lines);
+    }
+  }
+}
+
+// ============================================================================
+// Call Constraint Implementation
+// ============================================================================
+
+void TypeInference::solveCallConstraints(
+    const SectionPatternResolver &resolver) {
+  TypeConstraintGraph graph;
+
+  // One node per pattern parameter; the types its body needs are fixed
+  std::map<std::pair<const ResolvedPattern *, std::string>, size_t>
+      parameterNodes;
+  for (const auto &typed : typedPatternsData) {
+    for (const auto &[name, type] : typed->parameterTypes) {
+      size_t node = graph.addNode();
+      parameterNodes[{typed->pattern, name}] = node;
+      if (type != InferredType::Unknown) {
+        graph.require(node, type);
+      }
+    }
+  }
+
+  // The patterns whose body each call is in; top-level calls have none
+  std::map<const PatternMatch *, std::vector<const ResolvedPattern *>>
+      enclosingPatterns;
+  for (const auto &typed : typedPatternsData) {
+    if (!typed->pattern->body) {
+      continue;
+    }
+    std::vector<CodeLine *> lines;
+    collectBodyLines(typed->pattern->body, lines);
+    for (CodeLine *line : lines) {
+      if (PatternMatch *match = resolver.getPatternMatch(line)) {
+        enclosingPatterns[match].push_back(typed->pattern);
+      }
+    }
+  }
+
+  for (const auto &match : resolver.patternMatches()) {
+    if (!match->pattern) {
+      continue;
+    }
+    auto enclosing = enclosingPatterns.find(match.get());
+    for (const auto &[name, info] : match->arguments) {
+      auto parameter = parameterNodes.find({match->pattern, name});
+      if (parameter == parameterNodes.end()) {
+        continue;
+      }
+      InferredType valueType = resolvedToTyped(info.value, name).type;
+      if (valueType != InferredType::Unknown) {
+        graph.observe(parameter->second, valueType);
+        continue;
+      }
+
+      // An argument naming a parameter of the enclosing pattern passes that
+      // parameter on, so both have the same type
+      bool linked = false;
+      if (enclosing != enclosingPatterns.end() &&
+          std::holds_alternative<std::string>(info.value)) {
+        const std::string &identifier = std::get<std::string>(info.value);
+        for (const ResolvedPattern *pattern : enclosing->second) {
+          auto source = parameterNodes.find({pattern, identifier});
+          if (source != parameterNodes.end()) {
+            graph.unite(parameter->second, source->second);
+            linked = true;
+          }
+        }
+      }
+      if (!linked) {
+        graph.observe(parameter->second, InferredType::Unknown);
+      }
+    }
+  }
+
+  // Only fill in what the bodies left open, so a parameter never changes
+  // from a type its intrinsics need
+  graph.solve();
+  for (const auto &typed : typedPatternsData) {
+    for (auto &[name, type] : typed->parameterTypes) {
+      if (type == InferredType::Unknown) {
+        type = graph.solution(parameterNodes[{typed->pattern, name}]);
+      }
+    }
+  }
+}
+
+} // namespace tbx
@@ -384,17 +384,15 @@ std::vector<int32_t> LspServer::computeSemanticTokens(const std::string &uri) {
   }
 
   ImportResolver importResolver(sourceDir);
-  std::string mergedSource = importResolver.resolveWithPrelude(path, content);
+  const auto &mergedLines = importResolver.resolveWithPrelude(path, content);
 
   SectionAnalyzer sectionAnalyzer;
-  std::map<int, SectionAnalyzer::SourceLocation> sectionSourceMap;
-  for (const auto &[line, loc] : importResolver.sourceMap()) {
-    sectionSourceMap[line] = {loc.filePath, loc.lineNumber};
-  }
-  auto rootSection = sectionAnalyzer.analyze(mergedSource, sectionSourceMap);
+  sectionAnalyzer.setSubtreeCache(&sectionSubtrees);
+  auto sectionArena =
+      sectionAnalyzer.analyze(mergedLines, importResolver.sourceMap());
 
   SectionPatternResolver patternResolver;
-  patternResolver.resolve(rootSection.get());
+  patternResolver.resolve(sectionArena);
 
   // Group builder by line
   std::vector<std::string> lines;
@@ -547,7 +545,7 @@ LspServer::getDiagnostics(const std::string &content,
     std::string sourceDir = sourcePath.parent_path().string();
 
     ImportResolver importResolver(sourceDir);
-    std::string mergedSource =
+    const auto &mergedLines =
         importResolver.resolveWithPrelude(filename, content);
 
     auto addDiagnostics = [&](const std::vector<Diagnostic> &tbxDiags) {
@@ -583,17 +581,15 @@ LspServer::getDiagnostics(const std::string &content,
       return diagnostics;
 
     SectionAnalyzer sectionAnalyzer;
-    std::map<int, SectionAnalyzer::SourceLocation> sectionSourceMap;
-    for (const auto &[line, loc] : importResolver.sourceMap()) {
-      sectionSourceMap[line] = {loc.filePath, loc.lineNumber};
-    }
-    auto rootSection = sectionAnalyzer.analyze(mergedSource, sectionSourceMap);
+    sectionAnalyzer.setSubtreeCache(&sectionSubtrees);
+    auto sectionArena =
+        sectionAnalyzer.analyze(mergedLines, importResolver.sourceMap());
     addDiagnostics(sectionAnalyzer.diagnostics());
     if (!sectionAnalyzer.diagnostics().empty())
       return diagnostics;
 
     SectionPatternResolver patternResolver;
-    bool resolved = patternResolver.resolve(rootSection.get());
+    bool resolved = patternResolver.resolve(sectionArena);
 
     std::string uri = pathToUri(filename);
     patternDefinitions[uri].clear();
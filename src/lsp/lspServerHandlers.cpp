@@ -1,3 +1,4 @@
+#include "compiler/importPathCache.hpp"
 #include "compiler/importResolver.hpp"
 #include "compiler/patternResolver.hpp"
 #include "compiler/sectionAnalyzer.hpp"
@@ -60,6 +61,8 @@ void LspServer::handleNotification(const std::string &method,
     handleDidChange(params);
   } else if (method == "textDocument/didClose") {
     handleDidClose(params);
+  } else if (method == "workspace/didChangeWatchedFiles") {
+    handleDidChangeWatchedFiles(params);
   } else {
     log("Unknown notification method: " + method);
   }
@@ -192,6 +195,20 @@ void LspServer::handleDidClose(const json &params) {
   sendNotification("textDocument/publishDiagnostics", diagParams);
 }
 
+void LspServer::handleDidChangeWatchedFiles(const json &params) {
+  // Creating or deleting a file can change where imports resolve to; edits
+  // to a file's content cannot
+  const int changedType = 2;
+  for (const auto &change : params.value("changes", json::array())) {
+    if (change.value("type", 0) == changedType) {
+      continue;
+    }
+    std::string path = uriToPath(change.value("uri", ""));
+    ImportPathCache::global().invalidate(path);
+    log("Watched file created or deleted: " + path);
+  }
+}
+
 // ============================================================================
 // Pattern Extraction
 // ============================================================================
@@ -345,23 +362,8 @@ void LspServer::processImports(const std::string &uri,
 
 std::string LspServer::resolveImportPath(const std::string &importPath,
                                          const std::string &sourceDir) {
-  std::string fullPath = sourceDir + "/" + importPath;
-  if (std::ifstream(fullPath))
-    return fullPath;
-  fullPath = sourceDir + "/lib/" + importPath;
-  if (std::ifstream(fullPath))
-    return fullPath;
-  std::string searchDir = sourceDir;
-  for (int level = 0; level < 5; level++) {
-    fullPath = searchDir + "/lib/" + importPath;
-    if (std::ifstream(fullPath))
-      return fullPath;
-    size_t lastSlash = searchDir.rfind('/');
-    if (lastSlash == std::string::npos || lastSlash == 0)
-      break;
-    searchDir = searchDir.substr(0, lastSlash);
-  }
-  return "";
+  // Same search as the compiler, shared with it through ImportPathCache
+  return ImportResolver::findInSourceTree(importPath, sourceDir);
 }
 
 } // namespace tbx
@@ -8,6 +8,7 @@
 #include "lexer/lexer.hpp"
 #include "lsp/lspServer.hpp"
 
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -37,6 +38,9 @@ void printUsage(const char *program) {
       << "  --emit-obj      Output object file (.o) instead of executable\n";
   std::cerr << "  -c              Same as --emit-obj\n";
   std::cerr << "  -S              Same as --emit-asm\n";
+  std::cerr << "  -j <n>          Load imports, analyze files and match "
+               "patterns on <n>\n"
+               "                  threads (default 1)\n";
   std::cerr << "\nDebug/Analysis Options:\n";
   std::cerr << "  --emit-ir       Output LLVM IR to stdout (legacy, use "
                "--emit-llvm)\n";
@@ -128,6 +132,7 @@ int main(int argc, char *argv[]) {
   std::string sourceFile;
   std::string outputFile;
   tbx::OptimizationLevel optimizationLevel = tbx::OptimizationLevel::O2;
+  int jobCount = 1;
 
   for (int argIndex = 1; argIndex < argc; argIndex++) {
     std::string arg = argv[argIndex];
@@ -141,6 +146,10 @@ int main(int argc, char *argv[]) {
       emitObj = true;
     } else if (arg == "-o" && argIndex + 1 < argc) {
       outputFile = argv[++argIndex];
+    } else if (arg == "-j" && argIndex + 1 < argc) {
+      jobCount = std::atoi(argv[++argIndex]);
+    } else if (arg.rfind("-j", 0) == 0 && arg.size() > 2) {
+      jobCount = std::atoi(arg.c_str() + 2);
     } else if (arg == "-O0") {
       optimizationLevel = tbx::OptimizationLevel::O0;
     } else if (arg == "-O1") {
@@ -203,7 +212,8 @@ int main(int argc, char *argv[]) {
       std::cout << "=== Step 1: Import Resolution ===\n\n";
       fs::path sourcePathAbs = fs::absolute(sourceFile);
       tbx::ImportResolver resolver(sourcePathAbs.parent_path().string());
-      std::string mergedSource =
+      resolver.setJobCount(jobCount);
+      const auto &mergedLines =
           resolver.resolveWithPrelude(sourcePathAbs.string());
 
       if (!resolver.diagnostics().empty()) {
@@ -221,12 +231,9 @@ int main(int argc, char *argv[]) {
       // Step 2: Section Analysis
       std::cout << "=== Step 2: Section Analysis ===\n\n";
       tbx::SectionAnalyzer analyzer;
-      // Convert SourceMap type
-      std::map<int, tbx::SectionAnalyzer::SourceLocation> sectionSourceMap;
-      for (const auto &[line, loc] : resolver.sourceMap()) {
-        sectionSourceMap[line] = {loc.filePath, loc.lineNumber};
-      }
-      auto rootSection = analyzer.analyze(mergedSource, sectionSourceMap);
+      analyzer.setJobCount(jobCount);
+      auto sectionArena = analyzer.analyze(mergedLines, resolver.sourceMap());
+      tbx::Section *rootSection = sectionArena.root();
 
       if (!analyzer.diagnostics().empty()) {
         for (const auto &diagnostic : analyzer.diagnostics()) {
@@ -246,7 +253,8 @@ int main(int argc, char *argv[]) {
       std::cout << "=== Step 1: Import Resolution ===\n\n";
       fs::path sourcePathAbs = fs::absolute(sourceFile);
       tbx::ImportResolver importResolver(sourcePathAbs.parent_path().string());
-      std::string mergedSource =
+      importResolver.setJobCount(jobCount);
+      const auto &mergedLines =
           importResolver.resolveWithPrelude(sourcePathAbs.string());
 
       if (!importResolver.diagnostics().empty()) {
@@ -264,13 +272,10 @@ int main(int argc, char *argv[]) {
       // Step 2: Section Analysis
       std::cout << "=== Step 2: Section Analysis ===\n\n";
       tbx::SectionAnalyzer sectionAnalyzer;
-      // Convert SourceMap type
-      std::map<int, tbx::SectionAnalyzer::SourceLocation> sectionSourceMap;
-      for (const auto &[line, loc] : importResolver.sourceMap()) {
-        sectionSourceMap[line] = {loc.filePath, loc.lineNumber};
-      }
-      auto rootSection =
-          sectionAnalyzer.analyze(mergedSource, sectionSourceMap);
+      sectionAnalyzer.setJobCount(jobCount);
+      auto sectionArena =
+          sectionAnalyzer.analyze(mergedLines, importResolver.sourceMap());
+      tbx::Section *rootSection = sectionArena.root();
 
       if (!sectionAnalyzer.diagnostics().empty()) {
         for (const auto &diagnostic : sectionAnalyzer.diagnostics()) {
@@ -285,7 +290,8 @@ int main(int argc, char *argv[]) {
       // Step 3: Pattern Resolution
       std::cout << "=== Step 3: Pattern Resolution ===\n\n";
       tbx::SectionPatternResolver patternResolver;
-      bool resolved = patternResolver.resolve(rootSection.get());
+      patternResolver.setJobCount(jobCount);
+      bool resolved = patternResolver.resolve(sectionArena);
 
       if (!patternResolver.diagnostics().empty()) {
         for (const auto &diagnostic : patternResolver.diagnostics()) {
@@ -310,7 +316,8 @@ int main(int argc, char *argv[]) {
       std::cout << "=== Step 1: Import Resolution ===\n\n";
       fs::path sourcePathAbs = fs::absolute(sourceFile);
       tbx::ImportResolver importResolver(sourcePathAbs.parent_path().string());
-      std::string mergedSource =
+      importResolver.setJobCount(jobCount);
+      const auto &mergedLines =
           importResolver.resolveWithPrelude(sourcePathAbs.string());
 
       if (!importResolver.diagnostics().empty()) {
@@ -328,13 +335,10 @@ int main(int argc, char *argv[]) {
       // Step 2: Section Analysis
       std::cout << "=== Step 2: Section Analysis ===\n\n";
       tbx::SectionAnalyzer sectionAnalyzer;
-      // Convert SourceMap type
-      std::map<int, tbx::SectionAnalyzer::SourceLocation> sectionSourceMap;
-      for (const auto &[line, loc] : importResolver.sourceMap()) {
-        sectionSourceMap[line] = {loc.filePath, loc.lineNumber};
-      }
-      auto rootSection =
-          sectionAnalyzer.analyze(mergedSource, sectionSourceMap);
+      sectionAnalyzer.setJobCount(jobCount);
+      auto sectionArena =
+          sectionAnalyzer.analyze(mergedLines, importResolver.sourceMap());
+      tbx::Section *rootSection = sectionArena.root();
 
       if (!sectionAnalyzer.diagnostics().empty()) {
         for (const auto &diagnostic : sectionAnalyzer.diagnostics()) {
@@ -349,7 +353,8 @@ int main(int argc, char *argv[]) {
       // Step 3: Pattern Resolution
       std::cout << "=== Step 3: Pattern Resolution ===\n\n";
       tbx::SectionPatternResolver patternResolver;
-      bool resolved = patternResolver.resolve(rootSection.get());
+      patternResolver.setJobCount(jobCount);
+      bool resolved = patternResolver.resolve(sectionArena);
 
       if (!patternResolver.diagnostics().empty()) {
         for (const auto &diagnostic : patternResolver.diagnostics()) {
@@ -390,7 +395,8 @@ int main(int argc, char *argv[]) {
       std::cout << "=== Step 1: Import Resolution ===\n\n";
       fs::path sourcePathAbs = fs::absolute(sourceFile);
       tbx::ImportResolver importResolver(sourcePathAbs.parent_path().string());
-      std::string mergedSource =
+      importResolver.setJobCount(jobCount);
+      const auto &mergedLines =
           importResolver.resolveWithPrelude(sourcePathAbs.string());
 
       if (!importResolver.diagnostics().empty()) {
@@ -408,13 +414,10 @@ int main(int argc, char *argv[]) {
       // Step 2: Section Analysis
       std::cout << "=== Step 2: Section Analysis ===\n\n";
       tbx::SectionAnalyzer sectionAnalyzer;
-      // Convert SourceMap type
-      std::map<int, tbx::SectionAnalyzer::SourceLocation> sectionSourceMap;
-      for (const auto &[line, loc] : importResolver.sourceMap()) {
-        sectionSourceMap[line] = {loc.filePath, loc.lineNumber};
-      }
-      auto rootSection =
-          sectionAnalyzer.analyze(mergedSource, sectionSourceMap);
+      sectionAnalyzer.setJobCount(jobCount);
+      auto sectionArena =
+          sectionAnalyzer.analyze(mergedLines, importResolver.sourceMap());
+      tbx::Section *rootSection = sectionArena.root();
 
       if (!sectionAnalyzer.diagnostics().empty()) {
         for (const auto &diagnostic : sectionAnalyzer.diagnostics()) {
@@ -429,7 +432,8 @@ int main(int argc, char *argv[]) {
       // Step 3: Pattern Resolution
       std::cout << "=== Step 3: Pattern Resolution ===\n\n";
       tbx::SectionPatternResolver patternResolver;
-      bool resolved = patternResolver.resolve(rootSection.get());
+      patternResolver.setJobCount(jobCount);
+      bool resolved = patternResolver.resolve(sectionArena);
 
       if (!patternResolver.diagnostics().empty()) {
         for (const auto &diagnostic : patternResolver.diagnostics()) {
@@ -449,7 +453,7 @@ int main(int argc, char *argv[]) {
       std::cout << "=== Steps 4-5: Type Inference and Code Generation ===\n\n";
       tbx::SectionCodeGenerator codeGenerator(sourceFile);
       bool generated =
-          codeGenerator.generate(patternResolver, rootSection.get());
+          codeGenerator.generate(patternResolver, rootSection);
 
       if (!codeGenerator.diagnostics().empty()) {
         for (const auto &diagnostic : codeGenerator.diagnostics()) {
@@ -475,7 +479,8 @@ int main(int argc, char *argv[]) {
     // Step 1: Import Resolution
     fs::path sourcePathAbs = fs::absolute(sourceFile);
     tbx::ImportResolver importResolver(sourcePathAbs.parent_path().string());
-    std::string mergedSource =
+    importResolver.setJobCount(jobCount);
+    const auto &mergedLines =
         importResolver.resolveWithPrelude(sourcePathAbs.string());
 
     if (!importResolver.diagnostics().empty()) {
@@ -487,12 +492,10 @@ int main(int argc, char *argv[]) {
 
     // Step 2: Section Analysis
     tbx::SectionAnalyzer sectionAnalyzer;
-    // Convert SourceMap type
-    std::map<int, tbx::SectionAnalyzer::SourceLocation> sectionSourceMap;
-    for (const auto &[line, loc] : importResolver.sourceMap()) {
-      sectionSourceMap[line] = {loc.filePath, loc.lineNumber};
-    }
-    auto rootSection = sectionAnalyzer.analyze(mergedSource, sectionSourceMap);
+    sectionAnalyzer.setJobCount(jobCount);
+    auto sectionArena =
+        sectionAnalyzer.analyze(mergedLines, importResolver.sourceMap());
+    tbx::Section *rootSection = sectionArena.root();
 
     if (!sectionAnalyzer.diagnostics().empty()) {
       for (const auto &diagnostic : sectionAnalyzer.diagnostics()) {
@@ -503,7 +506,8 @@ int main(int argc, char *argv[]) {
 
     // Step 3: Pattern Resolution
     tbx::SectionPatternResolver patternResolver;
-    bool resolved = patternResolver.resolve(rootSection.get());
+    patternResolver.setJobCount(jobCount);
+    bool resolved = patternResolver.resolve(sectionArena);
 
     if (!patternResolver.diagnostics().empty()) {
       for (const auto &diagnostic : patternResolver.diagnostics()) {
@@ -518,7 +522,7 @@ int main(int argc, char *argv[]) {
 
     // Steps 4-5: Type Inference and Code Generation
     tbx::SectionCodeGenerator codeGenerator(sourceFile);
-    bool generated = codeGenerator.generate(patternResolver, rootSection.get());
+    bool generated = codeGenerator.generate(patternResolver, rootSection);
 
     if (!codeGenerator.diagnostics().empty()) {
       for (const auto &diagnostic : codeGenerator.diagnostics()) {